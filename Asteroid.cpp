@@ -10,11 +10,19 @@
 
 // ================================================ //
 
-AsteroidContainer::AsteroidContainer(void) :
+AsteroidContainer::AsteroidContainer(const Uint type, const Uint capacity) :
 m_data(),
-m_size(0)
+m_size(0),
+m_type(type),
+m_ring(),
+m_queue()
 {
-
+	if (m_type == AsteroidContainer::Type::LOCK_FREE){
+		m_ring.reset(new RingBuffer<Asteroid>(capacity));
+	}
+	else if (m_type == AsteroidContainer::Type::MULTI_QUEUE){
+		m_queue.reset(new MultiQueue<Asteroid, ImpactTimeKey>(capacity));
+	}
 }
 
 // ================================================ //
@@ -28,6 +36,13 @@ AsteroidContainer::~AsteroidContainer(void)
 
 bool AsteroidContainer::insert(const Asteroid& asteroid)
 {
+	if (m_ring){
+		return m_ring->push(asteroid);
+	}
+	if (m_queue){
+		return m_queue->push(asteroid);
+	}
+
 	if (this->full()){
 		return false;
 	}
@@ -52,15 +67,73 @@ bool AsteroidContainer::insert(const Asteroid& asteroid)
 
 // ================================================ //
 
+const Uint AsteroidContainer::insert(const Asteroid* asteroids, const Uint count)
+{
+	if (m_queue){
+		// One heap lock for the whole batch.
+		return m_queue->pushMany(asteroids, count);
+	}
+
+	Uint i = 0;
+	while (i < count && this->insert(asteroids[i])){
+		++i;
+	}
+
+	return i;
+}
+
+// ================================================ //
+
 const Asteroid AsteroidContainer::remove(void)
 {
+	Asteroid a = Asteroid();
+	// Safety measure, returns a zeroed asteroid if empty.
+	this->tryRemove(a);
+
+	return a;
+}
+
+// ================================================ //
+
+bool AsteroidContainer::tryRemove(Asteroid& asteroid)
+{
+	if (m_ring){
+		return m_ring->pop(asteroid);
+	}
+	if (m_queue){
+		return m_queue->pop(asteroid);
+	}
+
 	if (this->empty()){
-		// Safety measure.
-		return Asteroid();
+		return false;
 	}
 
 	// Return the last asteroid in queue (highest priority).
-	return m_data[--m_size];
+	asteroid = m_data[--m_size];
+	return true;
+}
+
+// ================================================ //
+
+const Uint AsteroidContainer::drainExpired(const Uint time, std::vector<Asteroid>& expired)
+{
+	if (m_ring){
+		return 0;
+	}
+	if (m_queue){
+		return m_queue->drainWhile([time](const Asteroid& a){
+			return (a.impactTime <= time);
+		}, expired);
+	}
+
+	// Soonest impacts sit at the end of the array.
+	Uint count = 0;
+	while (m_size > 0 && m_data[m_size - 1].impactTime <= time){
+		expired.push_back(m_data[--m_size]);
+		++count;
+	}
+
+	return count;
 }
 
 // ================================================ //
\ No newline at end of file
@@ -13,38 +13,83 @@
 // ================================================ //
 
 #include "stdafx.hpp"
+#include "RingBuffer.hpp"
+#include "MultiQueue.hpp"
 
 // ================================================ //
 
 // Data structure to describe an asteroid.
 struct Asteroid{
-	Uint id;
+	// The reporting scout's ID in the high 32 bits and its count of
+	// reports in the low, so neither can run into the other.
+	uint64_t id;
 	Uint mass;
 	Uint discoveryTime;
 	Uint impactTime;
 };
 
+// Priority key for asteroids, soonest impact first.
+struct ImpactTimeKey{
+	uint64_t operator()(const Asteroid& a) const{
+		return a.impactTime;
+	}
+};
+
 // ================================================ //
 // A container with queue operations.
 // "A" Option.
 class AsteroidContainer
 {
 public:
-	explicit AsteroidContainer(void);
+	// Backing storage for the container.
+	enum Type{
+		// Array-based priority queue, soonest impact first. Must be guarded
+		// externally (the TFC uses semaphores).
+		PRIORITY = 0,
+		// Lock-free MPMC ring buffer, first found first out. Safe to use
+		// from any number of threads without external locking.
+		LOCK_FREE,
+		// Relaxed concurrent priority queue (see MultiQueue), close to
+		// soonest impact first. Scales to thousands of asteroids and needs
+		// no external locking.
+		MULTI_QUEUE
+	};
+
+	// Capacity is fixed at MAX for Type::PRIORITY.
+	explicit AsteroidContainer(const Uint type = AsteroidContainer::Type::PRIORITY,
+							   const Uint capacity = AsteroidContainer::MAX);
 	~AsteroidContainer(void);
 
 	// Pushes an object into the stack. Returns false if stack is full.
 	bool insert(const Asteroid& asteroid);
 
+	// Pushes up to count objects, stopping when the stack is full. Returns
+	// number inserted, which are always the first ones.
+	const Uint insert(const Asteroid* asteroids, const Uint count);
+
 	// Pops the top item off the stack.
 	const Asteroid remove(void);
 
+	// Pops the top item off the stack into asteroid. Returns false if empty.
+	bool tryRemove(Asteroid& asteroid);
+
+	// Removes all asteroids whose impactTime is at or before time and
+	// appends them to expired. Returns number removed. The lock-free ring
+	// is not ordered, so it never drains anything.
+	const Uint drainExpired(const Uint time, std::vector<Asteroid>& expired);
+
 	// Returns true if stack is empty.
 	const bool empty(void) const;
 
 	// Returns true if stack is full.
 	const bool full(void) const;
 
+	// Returns true if the container needs no external synchronization.
+	const bool isConcurrent(void) const;
+
+	// Returns maximum number of items in container.
+	const Uint capacity(void) const;
+
 	// --- //
 
 	// Maximum number of items in container.
@@ -54,18 +99,49 @@ private:
 	// Array-based priority queue.
 	Asteroid m_data[MAX];
 	int m_size;
+	Uint m_type;
+	// Lock-free backing, only allocated for Type::LOCK_FREE.
+	std::unique_ptr<RingBuffer<Asteroid>> m_ring;
+	// Concurrent priority queue, only allocated for Type::MULTI_QUEUE.
+	std::unique_ptr<MultiQueue<Asteroid, ImpactTimeKey>> m_queue;
 };
 
 // ================================================ //
 
 inline const bool AsteroidContainer::empty(void) const{
+	if (m_ring){
+		return (m_ring->size() == 0);
+	}
+	if (m_queue){
+		return (m_queue->size() == 0);
+	}
 	return (m_size == 0);
 }
 
 inline const bool AsteroidContainer::full(void) const{
+	if (m_ring){
+		return (m_ring->size() >= m_ring->capacity());
+	}
+	if (m_queue){
+		return (m_queue->size() >= m_queue->capacity());
+	}
 	return (m_size == AsteroidContainer::MAX);
 }
 
+inline const bool AsteroidContainer::isConcurrent(void) const{
+	return (m_type != AsteroidContainer::Type::PRIORITY);
+}
+
+inline const Uint AsteroidContainer::capacity(void) const{
+	if (m_ring){
+		return m_ring->capacity();
+	}
+	if (m_queue){
+		return m_queue->capacity();
+	}
+	return AsteroidContainer::MAX;
+}
+
 // ================================================ //
 
 #endif
@@ -0,0 +1,190 @@
+// ================================================ //
+// File: AsteroidField.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements AsteroidField class.
+// ================================================ //
+
+#include "AsteroidField.hpp"
+#include "ScoutSampler.hpp"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+// ================================================ //
+
+// Identifies an asteroid field file of this record layout.
+static const uint32_t Magic = 0x4C324146;
+
+struct AsteroidField::Header{
+	uint32_t magic;
+	uint32_t recordSize;
+	uint64_t count;
+	uint64_t seed;
+	uint64_t pad;
+};
+
+// Asteroids generated per call to the sampler.
+static const Uint Chunk = 4096;
+
+// ================================================ //
+
+AsteroidField::AsteroidField(void) :
+m_fd(-1),
+m_base(nullptr),
+m_mapped(0),
+m_asteroids(nullptr),
+m_count(0),
+m_seed(0)
+{
+
+}
+
+// ================================================ //
+
+AsteroidField::~AsteroidField(void)
+{
+	this->close();
+}
+
+// ================================================ //
+
+const Uint AsteroidField::Generate(const std::string& path, const Uint count,
+								   const uint64_t seed)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr){
+		return 0;
+	}
+
+	Header header;
+	ZeroMemory(&header, sizeof(header));
+	header.magic = Magic;
+	header.recordSize = sizeof(Asteroid);
+	header.seed = seed;
+	if (fwrite(&header, sizeof(header), 1, file) != 1){
+		fclose(file);
+		return 0;
+	}
+
+	ScoutSampler sampler(seed);
+	std::vector<Uint> delays(Chunk), masses(Chunk), impacts(Chunk);
+	std::vector<Asteroid> asteroids(Chunk);
+	uint64_t time = 0;
+	Uint written = 0;
+	bool full = false;
+	while (written < count && full == false){
+		Uint n = std::min(count - written, Chunk);
+		sampler.discoveryTimes(&delays[0], n);
+		sampler.asteroidSizes(&masses[0], n);
+		sampler.timesToImpact(&impacts[0], n);
+
+		// Discovery times accumulate, so the records come out sorted.
+		Uint made = 0;
+		for (; made < n; ++made){
+			time += delays[made];
+			if (time + impacts[made] > UINT32_MAX){
+				full = true;
+				break;
+			}
+
+			Asteroid& a = asteroids[made];
+			a.id = written + made;
+			a.mass = masses[made];
+			a.discoveryTime = static_cast<Uint>(time);
+			a.impactTime = static_cast<Uint>(time + impacts[made]);
+		}
+
+		if (made > 0 && fwrite(&asteroids[0], sizeof(Asteroid), made, file) != made){
+			fclose(file);
+			return 0;
+		}
+		written += made;
+	}
+
+	// Write the count last, so a partial file never claims to be whole.
+	header.count = written;
+	if (fseek(file, 0, SEEK_SET) != 0 ||
+		fwrite(&header, sizeof(header), 1, file) != 1){
+		fclose(file);
+		return 0;
+	}
+
+	return (fclose(file) == 0) ? written : 0;
+}
+
+// ================================================ //
+
+bool AsteroidField::open(const std::string& path)
+{
+#if !defined(_WIN32)
+	this->close();
+
+	m_fd = ::open(path.c_str(), O_RDONLY);
+	if (m_fd < 0){
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(m_fd, &info) != 0 ||
+		info.st_size < static_cast<off_t>(sizeof(Header))){
+		this->close();
+		return false;
+	}
+
+	m_mapped = static_cast<size_t>(info.st_size);
+	void* p = mmap(nullptr, m_mapped, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if (p == MAP_FAILED){
+		m_mapped = 0;
+		this->close();
+		return false;
+	}
+	m_base = static_cast<char*>(p);
+
+	const Header* header = reinterpret_cast<const Header*>(m_base);
+	uint64_t whole = (m_mapped - sizeof(Header)) / sizeof(Asteroid);
+	if (header->magic != Magic || header->recordSize != sizeof(Asteroid) ||
+		header->count > whole){
+		this->close();
+		return false;
+	}
+
+	// Records are read front to back, so let the kernel read ahead.
+	madvise(m_base, m_mapped, MADV_SEQUENTIAL);
+
+	m_asteroids = reinterpret_cast<const Asteroid*>(m_base + sizeof(Header));
+	m_count = static_cast<Uint>(header->count);
+	m_seed = header->seed;
+
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+// ================================================ //
+
+void AsteroidField::close(void)
+{
+#if !defined(_WIN32)
+	if (m_base != nullptr){
+		munmap(m_base, m_mapped);
+	}
+	if (m_fd >= 0){
+		::close(m_fd);
+	}
+#endif
+	m_fd = -1;
+	m_base = nullptr;
+	m_mapped = 0;
+	m_asteroids = nullptr;
+	m_count = 0;
+	m_seed = 0;
+}
+
+// ================================================ //
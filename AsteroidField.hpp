@@ -0,0 +1,93 @@
+// ================================================ //
+// File: AsteroidField.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines AsteroidField class.
+// ================================================ //
+
+#ifndef __ASTEROIDFIELD_HPP__
+#define __ASTEROIDFIELD_HPP__
+
+// ================================================ //
+
+#include "Asteroid.hpp"
+
+// ================================================ //
+// A pre-generated asteroid field, so the same workload can be fed to the
+// TFC again and again without the scout rolling dice. The file is a short
+// header and an array of packed Asteroid records sorted by discoveryTime,
+// with times in ms from entering the field. Opened files are memory mapped
+// read-only, so a scout streams records straight out of the page cache
+// and any number of readers can share one field. Needs POSIX mmap() to
+// open; elsewhere open() fails.
+class AsteroidField
+{
+public:
+	// Creates an unopened field.
+	explicit AsteroidField(void);
+
+	// Unmaps the field.
+	~AsteroidField(void);
+
+	// Writes a field of up to count asteroids at path, replacing any file
+	// there, drawn from the scout's distributions (see ScoutSampler) with
+	// the given seed. Stops early rather than let discovery times overflow.
+	// Returns the number of asteroids written, or 0 on failure.
+	static const Uint Generate(const std::string& path, const Uint count,
+							   const uint64_t seed = 1);
+
+	// Maps the field at path read-only. Returns false if it can't be read
+	// or is not an asteroid field.
+	bool open(const std::string& path);
+
+	// Unmaps the field. Safe to call more than once.
+	void close(void);
+
+	// Getters
+
+	// Returns the number of asteroids in the field.
+	const Uint getCount(void) const;
+
+	// Returns asteroid i, in order of discovery.
+	const Asteroid& getAsteroid(const Uint i) const;
+
+	// Returns the seed the field was generated with.
+	const uint64_t getSeed(void) const;
+
+private:
+	// Not copyable.
+	AsteroidField(const AsteroidField&);
+	AsteroidField& operator=(const AsteroidField&);
+
+	struct Header;
+
+	int m_fd;
+	char* m_base;
+	size_t m_mapped;
+	const Asteroid* m_asteroids;
+	Uint m_count;
+	uint64_t m_seed;
+};
+
+// ================================================ //
+
+// Getters
+
+inline const Uint AsteroidField::getCount(void) const{
+	return m_count;
+}
+
+inline const Asteroid& AsteroidField::getAsteroid(const Uint i) const{
+	return m_asteroids[i];
+}
+
+inline const uint64_t AsteroidField::getSeed(void) const{
+	return m_seed;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,101 @@
+// ================================================ //
+// File: BatchRunner.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements BatchRunner class.
+// ================================================ //
+
+#include "BatchRunner.hpp"
+
+// ================================================ //
+
+BatchRunner::BatchRunner(const Config& config) :
+m_config(config)
+{
+
+}
+
+// ================================================ //
+
+BatchRunner::~BatchRunner(void)
+{
+
+}
+
+// ================================================ //
+
+const std::vector<BatchRunner::Report> BatchRunner::run(void)
+{
+	Uint sizes = (m_config.maxPhasers >= m_config.minPhasers) ?
+		m_config.maxPhasers - m_config.minPhasers + 1 : 0;
+
+	// Every run writes only its own slot, so workers share nothing.
+	std::vector<Simulation::Result> results(sizes * m_config.runs);
+	{
+		ThreadPool pool(m_config.threads);
+		for (Uint s = 0; s < sizes; ++s){
+			for (Uint i = 0; i < m_config.runs; ++i){
+				Simulation::Config scenario = m_config.scenario;
+				scenario.numPhasers = m_config.minPhasers + s;
+				scenario.seed = m_config.seed + i;
+				Simulation::Result* result = &results[s * m_config.runs + i];
+				pool.submit([scenario, result](){
+					Simulation sim(scenario);
+					*result = sim.run();
+				});
+			}
+		}
+		pool.wait();
+	}
+
+	std::vector<Report> reports;
+	for (Uint s = 0; s < sizes; ++s){
+		Report r;
+		ZeroMemory(&r, sizeof(r));
+		r.numPhasers = m_config.minPhasers + s;
+		r.runs = m_config.runs;
+
+		for (Uint i = 0; i < m_config.runs; ++i){
+			const Simulation::Result& result = results[s * m_config.runs + i];
+			r.phaserProbesLaunched = result.phaserProbesLaunched;
+			r.survived += (result.survived) ? 1 : 0;
+			r.meanShields += result.shields;
+			r.meanAsteroidsDestroyed += result.asteroidsDestroyed;
+			r.meanCollisions += result.collisions;
+			r.meanProbesLost += result.probesLost;
+			r.meanTime += result.time;
+		}
+
+		if (r.runs > 0){
+			double n = static_cast<double>(r.runs);
+			r.survivalRate = r.survived / n;
+			r.meanShields /= n;
+			r.meanAsteroidsDestroyed /= n;
+			r.meanCollisions /= n;
+			r.meanProbesLost /= n;
+			r.meanTime /= n;
+		}
+
+		reports.push_back(r);
+	}
+
+	return reports;
+}
+
+// ================================================ //
+
+void BatchRunner::Print(const std::vector<Report>& reports, FILE* out)
+{
+	fprintf(out, "%8s %8s %8s %9s %8s %10s %10s %8s %10s\n", "phasers", "launched",
+			"runs", "survival", "shields", "destroyed", "collisions", "lost", "time(s)");
+	for (std::vector<Report>::const_iterator itr = reports.begin(); 
+		 itr != reports.end(); ++itr){
+		fprintf(out, "%8u %8u %8u %8.1f%% %8.2f %10.2f %10.2f %8.2f %10.1f\n",
+				itr->numPhasers, itr->phaserProbesLaunched, itr->runs,
+				itr->survivalRate * 100.0, itr->meanShields, itr->meanAsteroidsDestroyed,
+				itr->meanCollisions, itr->meanProbesLost, itr->meanTime / 1000.0);
+	}
+}
+
+// ================================================ //
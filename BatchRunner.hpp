@@ -0,0 +1,94 @@
+// ================================================ //
+// File: BatchRunner.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines BatchRunner class.
+// ================================================ //
+
+#ifndef __BATCHRUNNER_HPP__
+#define __BATCHRUNNER_HPP__
+
+// ================================================ //
+
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+
+// ================================================ //
+// Monte Carlo sweep over fleet sizes. Runs many independent headless
+// scenarios for each number of phaser probes, spread across all cores with
+// a ThreadPool, and aggregates the outcomes per fleet size. Run i of every
+// fleet size uses the same seed, so sizes are compared on the same fields.
+class BatchRunner
+{
+public:
+	// Sweep options.
+	struct Config{
+		// Options shared by every run. numPhasers and seed are overwritten.
+		Simulation::Config scenario;
+		// Runs per fleet size.
+		Uint runs;
+		// Range of phaser probe counts to sweep, inclusive.
+		Uint minPhasers;
+		Uint maxPhasers;
+		// Seed of the first run.
+		Uint seed;
+		// Worker threads, zero for one per core.
+		Uint threads;
+
+		// Defaults to 1000 runs each of zero to ten phaser probes.
+		Config(void);
+	};
+
+	// Aggregated outcome for one fleet size.
+	struct Report{
+		Uint numPhasers;
+		// Phaser probes the TFC recorded launching, per run.
+		Uint phaserProbesLaunched;
+		Uint runs;
+		Uint survived;
+		// Fraction of runs ending in FLEET_SURVIVED.
+		double survivalRate;
+		// Means over all runs.
+		double meanShields;
+		double meanAsteroidsDestroyed;
+		double meanCollisions;
+		double meanProbesLost;
+		// Mean simulated time (ms).
+		double meanTime;
+	};
+
+	// Empty constructor.
+	explicit BatchRunner(const Config& config = Config());
+
+	// Empty destructor.
+	~BatchRunner(void);
+
+	// Runs the whole sweep, returning one report per fleet size in order.
+	const std::vector<Report> run(void);
+
+	// Writes reports as a table.
+	static void Print(const std::vector<Report>& reports, FILE* out);
+
+private:
+	Config m_config;
+};
+
+// ================================================ //
+
+inline BatchRunner::Config::Config(void) :
+scenario(),
+runs(1000),
+minPhasers(0),
+maxPhasers(10),
+seed(1),
+threads(0)
+{
+
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
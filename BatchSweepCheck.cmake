@@ -0,0 +1,45 @@
+# Runs the same --batch sweep with one asteroid per message and with
+# BATCH per message, and fails if batching loses more than TOLERANCE
+# tenths of a percent of survival summed over the fleet sizes. Run i of
+# each sweep uses the same seed, so both see the same fields.
+#
+# cmake -DLAB2=<Lab2Headless> -DRUNS=n -DMIN=n -DMAX=n -DBATCH=n
+#       -DTOLERANCE=n -P BatchSweepCheck.cmake
+
+# Returns the survival column of a sweep, summed, in tenths of a percent.
+function(sweep_survival batch result)
+	execute_process(COMMAND ${LAB2} --batch ${RUNS} ${MIN} ${MAX} ${batch}
+		OUTPUT_VARIABLE output
+		RESULT_VARIABLE status)
+	if(NOT status EQUAL 0)
+		message(FATAL_ERROR "--batch ${batch} failed (${status}):\n${output}")
+	endif()
+
+	string(REGEX MATCHALL "[0-9]+\\.[0-9]%" rates "${output}")
+	list(LENGTH rates count)
+	math(EXPR expected "${MAX} - ${MIN} + 1")
+	if(NOT count EQUAL expected)
+		message(FATAL_ERROR "Expected ${expected} fleet sizes:\n${output}")
+	endif()
+
+	set(total 0)
+	foreach(rate ${rates})
+		string(REPLACE "." "" rate "${rate}")
+		string(REPLACE "%" "" rate "${rate}")
+		math(EXPR total "${total} + ${rate}")
+	endforeach()
+
+	message("--batch ${RUNS} ${MIN} ${MAX} ${batch}:\n${output}")
+	set(${result} ${total} PARENT_SCOPE)
+endfunction()
+
+sweep_survival(1 single)
+sweep_survival(${BATCH} batched)
+
+math(EXPR floor "${single} - ${TOLERANCE}")
+if(batched LESS floor)
+	message(FATAL_ERROR "Batches of ${BATCH} lower survival: "
+		"${batched} against ${single} tenths of a percent.")
+endif()
+message("Survival with batches of ${BATCH}: ${batched} against ${single} "
+	"tenths of a percent.")
@@ -0,0 +1,392 @@
+// ================================================ //
+// File: Benchmark.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Microbenchmarks for Semaphore, AsteroidContainer,
+// the TFC's producer/consumer handoff and scout sampling.
+// ================================================ //
+
+#include "Asteroid.hpp"
+#include "Semaphore.hpp"
+#include "LatencyHistogram.hpp"
+#include "Probe.hpp"
+#include "ScoutSampler.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+// ================================================ //
+
+// Asteroid impact time orderings fed to the containers.
+enum Distribution{
+	// Uniformly random impact times.
+	RANDOM = 0,
+	// Each asteroid hits after the previous one.
+	ASCENDING,
+	// Each asteroid hits before the previous one, the worst case for an
+	// array kept in impact order.
+	DESCENDING,
+	NUM_DISTRIBUTIONS
+};
+
+static const char* DistributionNames[NUM_DISTRIBUTIONS] = {
+	"random", "ascending", "descending"
+};
+
+static const char* ContainerNames[] = {
+	"priority", "lock-free", "multi-queue"
+};
+
+// Operations and timing of one benchmark run. Every operation is timed, so
+// the figures include roughly 20-40 ns of clock overhead each.
+struct Result{
+	uint64_t ops;
+	double seconds;
+	LatencyHistogram* latency;
+};
+
+// ================================================ //
+
+// Returns a monotonic time stamp in nanoseconds.
+static int64_t Now(void)
+{
+	return Telemetry::Now();
+}
+
+// ================================================ //
+
+// Prints the column headings for PrintResult().
+static void PrintHeader(const char* title)
+{
+	printf("\n%s\n", title);
+	printf("%-34s %8s %12s %9s %9s %9s %9s\n", "benchmark", "threads", "ops/sec",
+		   "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+}
+
+// ================================================ //
+
+// Prints one row of results.
+static void PrintResult(const std::string& name, const Uint threads,
+						const Result& r)
+{
+	double rate = (r.seconds > 0.0) ? r.ops / r.seconds : 0.0;
+	printf("%-34s %8u %12.0f %9lld %9lld %9lld %9lld\n", name.c_str(), threads, rate,
+		   static_cast<long long>(r.latency->getPercentile(50.0)),
+		   static_cast<long long>(r.latency->getPercentile(99.0)),
+		   static_cast<long long>(r.latency->getPercentile(99.9)),
+		   static_cast<long long>(r.latency->getMax()));
+}
+
+// ================================================ //
+
+// Fills asteroids with impact times in the given order.
+static void MakeAsteroids(std::vector<Asteroid>& asteroids, const Uint count,
+						  const Uint distribution, const Uint seed)
+{
+	std::default_random_engine generator(seed);
+	std::uniform_int_distribution<Uint> impact(1, 1000000);
+
+	asteroids.resize(count);
+	for (Uint i = 0; i < count; ++i){
+		Asteroid& a = asteroids[i];
+		a.id = i;
+		a.mass = 1000;
+		a.discoveryTime = 0;
+		switch (distribution){
+		default:
+		case RANDOM:
+			a.impactTime = impact(generator);
+			break;
+
+		case ASCENDING:
+			a.impactTime = i + 1;
+			break;
+
+		case DESCENDING:
+			a.impactTime = count - i;
+			break;
+		}
+	}
+}
+
+// ================================================ //
+
+// Threads take turns through a Semaphore(1) used as a mutex, timing each
+// wait()/signal() pair.
+static Result BenchSemaphore(const Uint threads, const Uint ops)
+{
+	Semaphore sem(1);
+	LatencyHistogram* latency = new LatencyHistogram();
+	volatile Uint shared = 0;
+
+	Uint perThread = ops / threads;
+	int64_t start = Now();
+	std::vector<std::thread> workers;
+	for (Uint t = 0; t < threads; ++t){
+		workers.push_back(std::thread([&sem, latency, &shared, perThread](){
+			for (Uint i = 0; i < perThread; ++i){
+				int64_t begin = Now();
+				sem.wait();
+				shared = shared + 1;
+				sem.signal();
+				latency->record(Now() - begin);
+			}
+		}));
+	}
+	for (std::vector<std::thread>::iterator itr = workers.begin();
+		 itr != workers.end(); ++itr){
+		itr->join();
+	}
+
+	Result r;
+	r.ops = static_cast<uint64_t>(perThread) * threads;
+	r.seconds = (Now() - start) / 1e9;
+	r.latency = latency;
+	return r;
+}
+
+// ================================================ //
+
+// Repeatedly fills a container to capacity and empties it on one thread.
+// Times inserts and removes separately.
+static void BenchContainer(const Uint type, const Uint capacity,
+						   const Uint distribution, const Uint ops,
+						   Result& inserts, Result& removes)
+{
+	AsteroidContainer container(type, capacity);
+	Uint fill = container.capacity();
+	std::vector<Asteroid> asteroids;
+	MakeAsteroids(asteroids, fill, distribution, capacity);
+
+	inserts.latency = new LatencyHistogram();
+	removes.latency = new LatencyHistogram();
+	inserts.ops = removes.ops = 0;
+	int64_t insertTime = 0, removeTime = 0;
+
+	Uint rounds = std::max<Uint>(1, ops / fill);
+	for (Uint round = 0; round < rounds; ++round){
+		int64_t phase = Now();
+		for (Uint i = 0; i < fill; ++i){
+			int64_t begin = Now();
+			container.insert(asteroids[i]);
+			inserts.latency->record(Now() - begin);
+		}
+		insertTime += Now() - phase;
+
+		phase = Now();
+		Asteroid a;
+		for (Uint i = 0; i < fill; ++i){
+			int64_t begin = Now();
+			container.tryRemove(a);
+			removes.latency->record(Now() - begin);
+		}
+		removeTime += Now() - phase;
+
+		inserts.ops += fill;
+		removes.ops += fill;
+	}
+
+	inserts.seconds = insertTime / 1e9;
+	removes.seconds = removeTime / 1e9;
+}
+
+// ================================================ //
+
+// The asteroid handoff as done by TFC::insertAsteroids() and
+// TFC::takeTargets(): one scout thread produces, consumers take targets.
+// The PRIORITY container is guarded by the TFC's three semaphores; the
+// concurrent ones are used directly, consumers spinning when empty. Each
+// consumer take is timed, including any wait for an asteroid.
+static Result BenchHandoff(const Uint type, const Uint consumers, const Uint ops)
+{
+	AsteroidContainer container(type, AsteroidContainer::MAX);
+	Semaphore mutex(1), empty(container.capacity()), full(0);
+	bool guarded = (container.isConcurrent() == false);
+	LatencyHistogram* latency = new LatencyHistogram();
+
+	std::vector<Asteroid> asteroids;
+	MakeAsteroids(asteroids, 1024, RANDOM, consumers);
+
+	Uint perConsumer = ops / consumers;
+	Uint total = perConsumer * consumers;
+	int64_t start = Now();
+
+	std::thread producer([&](){
+		for (Uint i = 0; i < total; ++i){
+			const Asteroid& a = asteroids[i % asteroids.size()];
+			if (guarded){
+				empty.wait();
+				mutex.wait();
+				container.insert(a);
+				mutex.signal();
+				full.signal();
+			}
+			else{
+				while (container.insert(a) == false){
+					std::this_thread::yield();
+				}
+			}
+		}
+	});
+
+	std::vector<std::thread> workers;
+	for (Uint c = 0; c < consumers; ++c){
+		workers.push_back(std::thread([&](){
+			Asteroid a;
+			for (Uint i = 0; i < perConsumer; ++i){
+				int64_t begin = Now();
+				if (guarded){
+					full.wait();
+					mutex.wait();
+					container.tryRemove(a);
+					mutex.signal();
+					empty.signal();
+				}
+				else{
+					while (container.tryRemove(a) == false){
+						std::this_thread::yield();
+					}
+				}
+				latency->record(Now() - begin);
+			}
+		}));
+	}
+
+	producer.join();
+	for (std::vector<std::thread>::iterator itr = workers.begin();
+		 itr != workers.end(); ++itr){
+		itr->join();
+	}
+
+	Result r;
+	r.ops = total;
+	r.seconds = (Now() - start) / 1e9;
+	r.latency = latency;
+	return r;
+}
+
+// ================================================ //
+
+// Generates the scout's data for ops asteroids (discovery delay, mass and
+// time to impact) a sample at a time through Probe, as the scout does, or
+// in bulk through ScoutSampler. Blocks of SampleBlock asteroids are timed
+// and recorded as the mean per asteroid.
+static Result BenchSampler(const bool bulk, const Uint ops)
+{
+	static const Uint SampleBlock = 256;
+	Probe probe(Probe::Type::SCOUT);
+	probe.seed(1);
+	ScoutSampler sampler(1);
+	std::vector<Uint> discovery(SampleBlock), mass(SampleBlock), impact(SampleBlock);
+
+	Result r;
+	r.latency = new LatencyHistogram();
+	r.ops = 0;
+	uint64_t checksum = 0;
+
+	int64_t start = Now();
+	while (r.ops < ops){
+		int64_t begin = Now();
+		if (bulk){
+			sampler.discoveryTimes(&discovery[0], SampleBlock);
+			sampler.asteroidSizes(&mass[0], SampleBlock);
+			sampler.timesToImpact(&impact[0], SampleBlock);
+		}
+		else{
+			for (Uint i = 0; i < SampleBlock; ++i){
+				discovery[i] = probe.scoutDiscoveryTime();
+				mass[i] = probe.scoutAsteroidSize();
+				impact[i] = probe.scoutTimeToImpact();
+			}
+		}
+		r.latency->record((Now() - begin) / SampleBlock);
+		checksum += discovery[SampleBlock - 1] + mass[0] + impact[SampleBlock / 2];
+		r.ops += SampleBlock;
+	}
+	r.seconds = (Now() - start) / 1e9;
+
+	// Keep the samples from being optimized away.
+	if (checksum == 1){
+		printf(" ");
+	}
+
+	return r;
+}
+
+// ================================================ //
+
+// Usage: Benchmark [operations per run] [max threads]
+int main(int argc, char** argv)
+{
+	Uint ops = (argc > 1) ? static_cast<Uint>(atoi(argv[1])) : 1000000;
+	Uint maxThreads = (argc > 2) ? static_cast<Uint>(atoi(argv[2])) :
+		std::max<Uint>(1, std::thread::hardware_concurrency());
+	ops = std::max<Uint>(ops, 1);
+	maxThreads = std::max<Uint>(maxThreads, 1);
+
+	// Thread counts doubling up to maxThreads.
+	std::vector<Uint> threadCounts;
+	for (Uint t = 1; t < maxThreads; t *= 2){
+		threadCounts.push_back(t);
+	}
+	threadCounts.push_back(maxThreads);
+
+	PrintHeader("Semaphore wait/signal (as a mutex)");
+	for (std::vector<Uint>::iterator t = threadCounts.begin();
+		 t != threadCounts.end(); ++t){
+		Result r = BenchSemaphore(*t, ops);
+		PrintResult("semaphore", *t, r);
+		delete r.latency;
+	}
+
+	PrintHeader("AsteroidContainer fill and drain, one thread");
+	static const Uint capacities[] = { 16, 256, 4096 };
+	for (Uint type = AsteroidContainer::Type::PRIORITY;
+		 type <= AsteroidContainer::Type::MULTI_QUEUE; ++type){
+		for (Uint c = 0; c < sizeof(capacities) / sizeof(capacities[0]); ++c){
+			// The array-based priority queue is fixed at MAX.
+			if (type == AsteroidContainer::Type::PRIORITY && c > 0){
+				break;
+			}
+			for (Uint d = 0; d < NUM_DISTRIBUTIONS; ++d){
+				Result inserts, removes;
+				BenchContainer(type, capacities[c], d, ops, inserts, removes);
+				std::string name = std::string(ContainerNames[type]) + "/" +
+					toString((type == AsteroidContainer::Type::PRIORITY) ?
+						AsteroidContainer::MAX : capacities[c]) +
+					"/" + DistributionNames[d];
+				PrintResult(name + " insert", 1, inserts);
+				PrintResult(name + " remove", 1, removes);
+				delete inserts.latency;
+				delete removes.latency;
+			}
+		}
+	}
+
+	PrintHeader("Producer/consumer handoff (1 producer, N consumers)");
+	for (Uint type = AsteroidContainer::Type::PRIORITY;
+		 type <= AsteroidContainer::Type::MULTI_QUEUE; ++type){
+		for (std::vector<Uint>::iterator t = threadCounts.begin();
+			 t != threadCounts.end(); ++t){
+			Result r = BenchHandoff(type, *t, ops);
+			PrintResult(std::string(ContainerNames[type]) + " handoff", *t, r);
+			delete r.latency;
+		}
+	}
+
+	PrintHeader("Scout asteroid sampling (ops are asteroids)");
+	{
+		Result r = BenchSampler(false, ops);
+		PrintResult("per sample (Probe)", 1, r);
+		delete r.latency;
+
+		r = BenchSampler(true, ops);
+		PrintResult((ScoutSampler::IsVectorized()) ? "bulk (ScoutSampler, AVX2)" :
+					"bulk (ScoutSampler, scalar)", 1, r);
+		delete r.latency;
+	}
+
+	return 0;
+}
+
+// ================================================ //
@@ -0,0 +1,313 @@
+// ================================================ //
+// File: Channel.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements SocketChannel class.
+// ================================================ //
+
+#include "Channel.hpp"
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+// ================================================ //
+
+#if defined(__linux__)
+
+// Runs a callback once for each socket it is asked to watch, when the
+// socket becomes readable or fails, from one epoll thread shared by every
+// SocketChannel. Registrations are one-shot, so a socket is only reported
+// to whoever asked last.
+class SocketWatcher
+{
+public:
+	// Starts the thread. Never destroyed, since detached probes may still
+	// be waiting on it while the process exits.
+	SocketWatcher(void) :
+	m_epoll(epoll_create1(0)),
+	m_mutex(),
+	m_callbacks()
+	{
+		if (m_epoll >= 0){
+			std::thread t(&SocketWatcher::run, this);
+			t.detach();
+		}
+	}
+
+	// Returns false if epoll is unavailable.
+	bool watch(const SOCKET socket, const std::function<void(void)>& callback){
+		if (m_epoll < 0){
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_callbacks[socket] = callback;
+
+		// Level-triggered, so data already waiting is reported at once.
+		struct epoll_event ev;
+		ZeroMemory(&ev, sizeof(ev));
+		ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+		ev.data.fd = socket;
+		if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket, &ev) != 0 &&
+			epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &ev) != 0){
+			m_callbacks.erase(socket);
+			return false;
+		}
+
+		return true;
+	}
+
+	// Stops watching a socket about to be closed, dropping its callback.
+	void forget(const SOCKET socket){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, nullptr);
+		m_callbacks.erase(socket);
+	}
+
+private:
+	void run(void){
+		struct epoll_event events[64];
+		for (;;){
+			int n = epoll_wait(m_epoll, events, 64, -1);
+			for (int i = 0; i < n; ++i){
+				std::function<void(void)> callback;
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					std::unordered_map<SOCKET, std::function<void(void)>>::iterator itr =
+						m_callbacks.find(events[i].data.fd);
+					if (itr == m_callbacks.end()){
+						continue;
+					}
+					callback.swap(itr->second);
+					m_callbacks.erase(itr);
+				}
+				callback();
+			}
+		}
+	}
+
+	int m_epoll;
+	std::mutex m_mutex;
+	std::unordered_map<SOCKET, std::function<void(void)>> m_callbacks;
+};
+
+// ================================================ //
+
+static SocketWatcher& Watcher(void)
+{
+	static SocketWatcher* watcher = new SocketWatcher();
+	return *watcher;
+}
+
+#endif
+
+// ================================================ //
+
+Channel::Channel(void) :
+m_taken()
+{
+
+}
+
+// ================================================ //
+
+Channel::~Channel(void)
+{
+
+}
+
+// ================================================ //
+
+const Probe::Message* Channel::take(void)
+{
+	return (this->receive(m_taken)) ? &m_taken : nullptr;
+}
+
+// ================================================ //
+
+void Channel::release(const Probe::Message* msg)
+{
+	(void)msg;
+}
+
+// ================================================ //
+
+void Channel::interrupt(void)
+{
+	this->disconnect();
+}
+
+// ================================================ //
+
+bool Channel::setReadyCallback(const std::function<void(void)>& callback)
+{
+	(void)callback;
+	return false;
+}
+
+// ================================================ //
+
+bool Channel::notifyWhenReady(const std::function<void(void)>& callback)
+{
+	(void)callback;
+	return false;
+}
+
+// ================================================ //
+
+SocketChannel::SocketChannel(const SOCKET socket) :
+m_socket(socket),
+m_decoder(),
+m_out(),
+m_watched(false)
+{
+
+}
+
+// ================================================ //
+
+SocketChannel::~SocketChannel(void)
+{
+	this->disconnect();
+}
+
+// ================================================ //
+
+bool SocketChannel::send(const Probe::Message& msg)
+{
+	Frame::Encode(msg, m_out);
+	return this->flush();
+}
+
+// ================================================ //
+
+bool SocketChannel::send(const std::vector<Probe::Message>& msgs)
+{
+	for (std::vector<Probe::Message>::const_iterator itr = msgs.begin();
+		 itr != msgs.end(); ++itr){
+		Frame::Encode(*itr, m_out);
+	}
+	return this->flush();
+}
+
+// ================================================ //
+
+bool SocketChannel::receive(Probe::Message& msg)
+{
+	// A previous recv() may already hold the next message.
+	while (m_decoder.next(msg) == false){
+		if (m_decoder.isCorrupt()){
+			printf("Channel: malformed frame on socket %ld\n", 
+				   static_cast<long>(m_socket));
+			return false;
+		}
+
+		char buffer[4096];
+		int r = recv(m_socket, buffer, sizeof(buffer), 0);
+		if (r <= 0){
+			return false;
+		}
+		m_decoder.append(buffer, r);
+	}
+
+	return true;
+}
+
+// ================================================ //
+
+bool SocketChannel::poll(void)
+{
+	if (m_decoder.empty() == false || m_socket == INVALID_SOCKET){
+		return true;
+	}
+
+	// poll() rather than select(), whose fd_set can't hold sockets
+	// numbered FD_SETSIZE or above. Errors and hangups count as ready, so
+	// receive() reports them.
+#if defined(_WIN32)
+	WSAPOLLFD request;
+	request.fd = m_socket;
+	request.events = POLLRDNORM;
+	request.revents = 0;
+	return (WSAPoll(&request, 1, 0) != 0);
+#else
+	struct pollfd request;
+	request.fd = m_socket;
+	request.events = POLLIN;
+	request.revents = 0;
+	return (::poll(&request, 1, 0) != 0);
+#endif
+}
+
+// ================================================ //
+
+void SocketChannel::disconnect(void)
+{
+	std::lock_guard<std::mutex> lock(m_closeMutex);
+	if (m_socket != INVALID_SOCKET){
+#if defined(__linux__)
+		if (m_watched){
+			Watcher().forget(m_socket);
+		}
+#endif
+		closesocket(m_socket);
+		m_socket = INVALID_SOCKET;
+	}
+}
+
+// ================================================ //
+
+void SocketChannel::interrupt(void)
+{
+	std::lock_guard<std::mutex> lock(m_closeMutex);
+	if (m_socket != INVALID_SOCKET){
+		shutdown(m_socket, SD_BOTH);
+	}
+}
+
+// ================================================ //
+
+bool SocketChannel::notifyWhenReady(const std::function<void(void)>& callback)
+{
+#if defined(__linux__)
+	if (m_decoder.empty() == false || m_socket == INVALID_SOCKET){
+		callback();
+		return true;
+	}
+
+	m_watched = true;
+	return Watcher().watch(m_socket, callback);
+#else
+	(void)callback;
+	return false;
+#endif
+}
+
+// ================================================ //
+
+bool SocketChannel::flush(void)
+{
+	// A blocking send() may still write only part of the buffer.
+	size_t sent = 0;
+	while (sent < m_out.size()){
+		int s = ::send(m_socket, &m_out[sent], static_cast<int>(m_out.size() - sent),
+					   MSG_NOSIGNAL);
+		if (s <= 0){
+			m_out.clear();
+			return false;
+		}
+		sent += s;
+	}
+
+	m_out.clear();
+	return true;
+}
+
+// ================================================ //
@@ -0,0 +1,151 @@
+// ================================================ //
+// File: Channel.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Channel interface and SocketChannel class.
+// ================================================ //
+
+#ifndef __CHANNEL_HPP__
+#define __CHANNEL_HPP__
+
+// ================================================ //
+
+#include "Protocol.hpp"
+#include <functional>
+
+// ================================================ //
+// Blocking message stream between a probe and the TFC. Used by the probes
+// and the thread-per-probe server; the reactor frames its non-blocking
+// sockets directly.
+class Channel
+{
+public:
+	// Initializes member variables.
+	explicit Channel(void);
+
+	// Closes the connection.
+	virtual ~Channel(void);
+
+	// Sends one message. Returns false if the connection failed.
+	virtual bool send(const Probe::Message& msg) = 0;
+
+	// Sends every message in msgs at once where possible. Returns false if
+	// the connection failed.
+	virtual bool send(const std::vector<Probe::Message>& msgs) = 0;
+
+	// Blocks until a whole message arrives. Returns false if the connection
+	// was closed, failed, or sent a malformed message.
+	virtual bool receive(Probe::Message& msg) = 0;
+
+	// Like receive(), but returns the buffer holding the message instead of
+	// copying it out. It stays valid until handed back with release(),
+	// which must come before the next take(). Returns nullptr where
+	// receive() would return false. By default the message is received
+	// into a buffer of the channel's.
+	virtual const Probe::Message* take(void);
+
+	// Hands back a message returned by take().
+	virtual void release(const Probe::Message* msg);
+
+	// Returns true if receive() would return without waiting long: data is
+	// buffered or arriving, or the connection has closed. Never blocks.
+	virtual bool poll(void) = 0;
+
+	// Closes the connection. Safe to call more than once.
+	virtual void disconnect(void) = 0;
+
+	// Makes a receive() blocked on another thread return false, along with
+	// every later one, without freeing anything that thread is using. Safe
+	// to call from any thread; the reader still disconnects. The default
+	// disconnects, for channels where that is already safe.
+	virtual void interrupt(void);
+
+	// Asks for callback to be run, on the sending thread, whenever a message
+	// arrives or the connection closes, so the reader can be scheduled as a
+	// task instead of blocking in receive(). Must be set before the other
+	// end starts sending. Returns false if the channel can't notify, which
+	// is the default.
+	virtual bool setReadyCallback(const std::function<void(void)>& callback);
+
+	// Asks for callback to be run once, as soon as poll() would return
+	// true: on the calling thread if it already would, otherwise on
+	// whichever thread notices. Lets a reader wait for a reply without a
+	// thread or a timer. Returns false, without running callback, if the
+	// channel can't notify, which is the default; the reader must then
+	// poll().
+	virtual bool notifyWhenReady(const std::function<void(void)>& callback);
+
+private:
+	// Holds the message from the default take().
+	Probe::Message m_taken;
+};
+
+// ================================================ //
+// Channel over a connected socket, each message framed (see Frame).
+class SocketChannel : public Channel
+{
+public:
+	// Takes ownership of socket.
+	explicit SocketChannel(const SOCKET socket = INVALID_SOCKET);
+
+	// Closes the socket.
+	virtual ~SocketChannel(void);
+
+	// Sends one message. Returns false if the connection failed.
+	virtual bool send(const Probe::Message& msg);
+
+	// Sends every message in msgs with a single send() where possible.
+	// Returns false if the connection failed.
+	virtual bool send(const std::vector<Probe::Message>& msgs);
+
+	// Blocks until a whole message arrives. Returns false if the connection
+	// was closed, failed, or sent a malformed frame.
+	virtual bool receive(Probe::Message& msg);
+
+	// Returns true if receive() would return without waiting long: data is
+	// buffered or arriving, or the connection has closed. Never blocks.
+	virtual bool poll(void);
+
+	// Closes the socket. Safe to call more than once.
+	virtual void disconnect(void);
+
+	// Shuts the socket down, which wakes a blocked recv(), and leaves
+	// closing it to disconnect().
+	virtual void interrupt(void);
+
+	// Watches the socket with a process-wide epoll thread on Linux; returns
+	// false elsewhere.
+	virtual bool notifyWhenReady(const std::function<void(void)>& callback);
+
+	// Getters
+
+	// Returns the underlying socket.
+	const SOCKET getSocket(void) const;
+
+private:
+	// Writes all of m_out to the socket and empties it.
+	bool flush(void);
+
+	SOCKET m_socket;
+	FrameDecoder m_decoder;
+	std::vector<char> m_out;
+	// True once the socket has been handed to the watcher.
+	bool m_watched;
+	// Keeps interrupt() from using the socket while it is being closed.
+	std::mutex m_closeMutex;
+};
+
+// ================================================ //
+
+// Getters
+
+inline const SOCKET SocketChannel::getSocket(void) const{
+	return m_socket;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,338 @@
+// ================================================ //
+// File: Console.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements Console class.
+// ================================================ //
+
+#include "Console.hpp"
+#include "TFC.hpp"
+#include "Probe.hpp"
+#include "Timer.hpp"
+#include "TimerWheel.hpp"
+#include "Simulation.hpp"
+#include "BatchRunner.hpp"
+#include "Journal.hpp"
+#include "Replay.hpp"
+#include "AsteroidField.hpp"
+#include "LatencyHistogram.hpp"
+#include <cstdlib>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+// ================================================ //
+
+const bool Console::Handles(const int argc, char** argv)
+{
+	if (argc < 2){
+		return false;
+	}
+
+	std::string mode(argv[1]);
+	return (mode == "--headless" || mode == "--batch" || mode == "--live" ||
+			mode == "--replay" || mode == "--make-field");
+}
+
+// ================================================ //
+
+int Console::Run(const int argc, char** argv)
+{
+	std::string mode((argc > 1) ? argv[1] : "");
+	if (mode == "--headless"){
+		return Console::RunHeadless(argc, argv);
+	}
+	if (mode == "--batch"){
+		return Console::RunBatch(argc, argv);
+	}
+	if (mode == "--live"){
+		return Console::RunLive(argc, argv);
+	}
+	if (mode == "--replay"){
+		return Console::RunReplay(argc, argv);
+	}
+	if (mode == "--make-field"){
+		return Console::RunMakeField(argc, argv);
+	}
+
+	Console::PrintUsage(stderr);
+	return 1;
+}
+
+// ================================================ //
+
+void Console::PrintUsage(FILE* out)
+{
+	fprintf(out, "Usage:\n"
+			"  --headless [phasers] [seed] [batch size] [field]\n"
+			"  --batch [runs] [min phasers] [max phasers] [batch size]\n"
+			"  --live [phasers] [speed] [server mode] [reactors] [transport] [journal|-]\n"
+			"         [field] [fast]\n"
+			"  --replay <journal> [container type]\n"
+			"  --make-field <field> <asteroids> [seed]\n");
+}
+
+// ================================================ //
+
+int Console::RunHeadless(const int argc, char** argv)
+{
+	Simulation::Config config;
+	if (argc > 2){
+		config.numPhasers = static_cast<Uint>(atoi(argv[2]));
+	}
+	if (argc > 3){
+		config.seed = static_cast<Uint>(atoi(argv[3]));
+	}
+	if (argc > 4){
+		config.batchSize = static_cast<Uint>(atoi(argv[4]));
+	}
+	AsteroidField field;
+	if (argc > 5){
+		if (field.open(argv[5]) == false){
+			fprintf(stderr, "Failed to open asteroid field %s.\n", argv[5]);
+			return 1;
+		}
+		config.field = &field;
+	}
+
+	Simulation sim(config);
+	Simulation::Result r = sim.run();
+	printf("Fleet %s: shields %d, asteroids found %u, destroyed %u, collisions %u, "
+		   "probes lost %u, %u ms simulated, %u events\n",
+		   (r.survived) ? "survived" : "destroyed", r.shields, r.asteroidsFound,
+		   r.asteroidsDestroyed, r.collisions, r.probesLost, r.time, r.events);
+	printf("\nTFC latency (wall clock):\n");
+	Telemetry::Print(stdout);
+
+	return (r.survived) ? 0 : 2;
+}
+
+// ================================================ //
+
+int Console::RunBatch(const int argc, char** argv)
+{
+	BatchRunner::Config config;
+	if (argc > 2){
+		config.runs = static_cast<Uint>(atoi(argv[2]));
+	}
+	if (argc > 3){
+		config.minPhasers = static_cast<Uint>(atoi(argv[3]));
+	}
+	if (argc > 4){
+		config.maxPhasers = static_cast<Uint>(atoi(argv[4]));
+	}
+	if (argc > 5){
+		config.scenario.batchSize = static_cast<Uint>(atoi(argv[5]));
+	}
+
+	Timer timer(true);
+	BatchRunner runner(config);
+	std::vector<BatchRunner::Report> reports = runner.run();
+	BatchRunner::Print(reports, stdout);
+	printf("%u scenarios in %u ms\n",
+		   static_cast<Uint>(reports.size()) * config.runs, timer.getTicks());
+	printf("\nTFC latency (wall clock, all scenarios):\n");
+	Telemetry::Print(stdout);
+
+	return 0;
+}
+
+// ================================================ //
+
+int Console::RunLive(const int argc, char** argv)
+{
+	Uint numPhasers = (argc > 2) ? static_cast<Uint>(atoi(argv[2])) : 10;
+	double speed = (argc > 3) ? atof(argv[3]) : 1.0;
+
+	TFC::Config config;
+	if (argc > 4){
+		config.serverMode = static_cast<Uint>(atoi(argv[4]));
+	}
+	if (argc > 5){
+		config.numReactors = static_cast<Uint>(atoi(argv[5]));
+	}
+	Uint transport = (argc > 6) ? static_cast<Uint>(atoi(argv[6])) :
+		static_cast<Uint>(Probe::Transport::SOCKET_STREAM);
+	if (config.serverMode == TFC::ServerMode::HEADLESS){
+		fprintf(stderr, "--live needs a socket server mode.\n");
+		return 1;
+	}
+
+	// Handlers are detached and may still be appending at exit, so the
+	// journal is never freed either; close() waits them out.
+	Journal* journal = nullptr;
+	if (argc > 7 && std::string(argv[7]) != "-"){
+		journal = new Journal();
+		if (journal->create(argv[7]) == false){
+			fprintf(stderr, "Failed to create journal %s.\n", argv[7]);
+			return 1;
+		}
+		config.journal = journal;
+	}
+
+	// Likewise the scout may still be reading the field at exit.
+	AsteroidField* field = nullptr;
+	if (argc > 8){
+		field = new AsteroidField();
+		if (field->open(argv[8]) == false){
+			fprintf(stderr, "Failed to open asteroid field %s.\n", argv[8]);
+			return 1;
+		}
+	}
+	bool fast = (argc > 9 && atoi(argv[9]) != 0);
+
+#if defined(_WIN32)
+	// Initialize Winsock, begin using WS2_32.DLL.
+	WSAData wsaData;
+	if (WSAStartup(0x101, &wsaData) != 0){
+		return 1;
+	}
+#else
+	// A probe dropping its connection must not kill the process.
+	signal(SIGPIPE, SIG_IGN);
+
+	// Both ends of every socket probe live in this process, so raise the
+	// descriptor limit as far as allowed.
+	struct rlimit files;
+	if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max){
+		files.rlim_cur = files.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &files);
+	}
+#endif
+
+	Timer::Multiplier = (speed > 0.0) ? speed : 1.0;
+
+	// Probes run on the wheel until the process exits, so it and they are
+	// never freed. The TFC is, once the fleet is through, which closes the
+	// probes' channels.
+	TFC* tfc = new TFC(config);
+	if (tfc->getInitError() != 0){
+		delete tfc;
+		return 1;
+	}
+	TimerWheel* wheel = new TimerWheel();
+	std::vector<std::shared_ptr<Probe>>* probes = new std::vector<std::shared_ptr<Probe>>();
+
+	probes->push_back(std::make_shared<Probe>(Probe::Type::SCOUT,
+		(fast) ? Probe::BatchMax : 1));
+	if (field != nullptr){
+		probes->front()->stream(field, fast == false);
+	}
+	for (int i = 0; i < 2; ++i){
+		probes->push_back(std::make_shared<Probe>(Probe::Type::PHOTON));
+	}
+	for (Uint i = 0; i < numPhasers; ++i){
+		probes->push_back(std::make_shared<Probe>(Probe::Type::PHASER));
+	}
+	for (std::vector<std::shared_ptr<Probe>>::iterator itr = probes->begin();
+		 itr != probes->end(); ++itr){
+		if ((*itr)->launch(wheel, transport) == false){
+			fprintf(stderr, "Failed to launch probe!\n");
+			return 1;
+		}
+	}
+
+	Timer timer(true);
+	tfc->enterAsteroidField();
+	// No renderer consumes the TFC's GUI events here, so drain and drop
+	// them while waiting, or they pile up for the whole run.
+	std::vector<GUIEvent> events;
+	while (tfc->isInAsteroidField()){
+		GUIEvent e;
+		if (tfc->waitGUIEvent(e, 100)){
+			tfc->drainGUIEvents(events);
+			events.clear();
+		}
+	}
+
+	printf("Fleet %s: shields %u, asteroids destroyed %u, %u phaser probes, "
+		   "%u ms simulated\n", (tfc->isFleetAlive()) ? "survived" : "destroyed",
+		   tfc->getShields(), tfc->getNumAsteroidsDestroyed(),
+		   tfc->getNumPhaserProbesLaunched(), timer.getTicks());
+	bool alive = tfc->isFleetAlive();
+	delete tfc;
+
+	if (journal != nullptr){
+		journal->close();
+		printf("Journal: %u records written to %s, %u dropped\n",
+			   journal->getCount(), argv[7], journal->getDropped());
+	}
+	printf("\nLatency (wall clock):\n");
+	Telemetry::Print(stdout);
+	fflush(stdout);
+
+	return (alive) ? 0 : 2;
+}
+
+// ================================================ //
+
+int Console::RunReplay(const int argc, char** argv)
+{
+	if (argc < 3){
+		Console::PrintUsage(stderr);
+		return 1;
+	}
+
+	Journal journal;
+	if (journal.open(argv[2]) == false){
+		fprintf(stderr, "Failed to open journal %s.\n", argv[2]);
+		return 1;
+	}
+
+	Uint containerType = (argc > 3) ? static_cast<Uint>(atoi(argv[3])) :
+		static_cast<Uint>(AsteroidContainer::Type::PRIORITY);
+	Replay replay(journal, containerType);
+	Replay::Result r = replay.run();
+
+	double seconds = static_cast<double>(r.elapsed) / 1e9;
+	printf("Fleet %s: shields %d, asteroids destroyed %u, %u probes, "
+		   "%u ms simulated\n", (r.survived) ? "survived" : "destroyed",
+		   r.shields, r.asteroidsDestroyed, r.probes, r.time);
+	printf("Replayed %u messages in %.3f ms (%.0f messages/s)\n", r.messages,
+		   seconds * 1e3, (seconds > 0.0) ? r.messages / seconds : 0.0);
+	if (r.divergences == 0){
+		printf("Matched all %u decisions in the journal\n", r.decisions);
+	}
+	else{
+		printf("Diverged from the journal on %u of %u decisions, first at record %u\n",
+			   r.divergences, r.decisions, r.firstDivergence);
+	}
+	printf("\nTFC latency (wall clock):\n");
+	Telemetry::Print(stdout);
+
+	return (r.survived) ? 0 : 2;
+}
+
+// ================================================ //
+
+int Console::RunMakeField(const int argc, char** argv)
+{
+	if (argc < 4){
+		Console::PrintUsage(stderr);
+		return 1;
+	}
+
+	Uint count = static_cast<Uint>(strtoul(argv[3], nullptr, 10));
+	uint64_t seed = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 1;
+
+	Timer timer(true);
+	Uint written = AsteroidField::Generate(argv[2], count, seed);
+	if (written == 0){
+		fprintf(stderr, "Failed to write asteroid field %s.\n", argv[2]);
+		return 1;
+	}
+	Uint ms = timer.getTicks();
+
+	printf("Wrote %u asteroids to %s (seed %llu) in %u ms\n", written, argv[2],
+		   static_cast<unsigned long long>(seed), ms);
+	if (written < count){
+		printf("Stopped early: discovery times would overflow.\n");
+	}
+
+	return 0;
+}
+
+// ================================================ //
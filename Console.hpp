@@ -0,0 +1,68 @@
+// ================================================ //
+// File: Console.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Console class.
+// ================================================ //
+
+#ifndef __CONSOLE_HPP__
+#define __CONSOLE_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// ================================================ //
+// Command line modes which need no GUI, shared by the Win32 front end and
+// the portable headless executable.
+class Console
+{
+public:
+	// Returns true if argv names one of the console modes.
+	static const bool Handles(const int argc, char** argv);
+
+	// Runs the mode named by argv[1]. Returns the process exit code.
+	static int Run(const int argc, char** argv);
+
+	// Writes the command line usage.
+	static void PrintUsage(FILE* out);
+
+private:
+	// Runs one scenario in virtual time and prints the outcome.
+	// If a field is given the scout reports it instead of rolling
+	// asteroids (see AsteroidField).
+	// Usage: --headless [phasers] [seed] [batch size] [field]
+	static int RunHeadless(const int argc, char** argv);
+
+	// Sweeps fleet sizes across many headless scenarios on all cores and
+	// prints the aggregate report.
+	// Usage: --batch [runs] [min phasers] [max phasers] [batch size]
+	static int RunBatch(const int argc, char** argv);
+
+	// Runs the real TFC server and probes over loopback sockets, shared
+	// memory or in-process channels (see Probe::Transport), until the fleet
+	// leaves the field, sped up by Timer::Multiplier.
+	// If a journal path is given, everything the TFC handles is recorded
+	// there (see Journal); "-" records nothing. If a field is given the
+	// scout streams it at its recorded times, or as fast as the TFC takes
+	// it if fast is non-zero.
+	// Usage: --live [phasers] [speed] [server mode] [reactors] [transport]
+	//               [journal|-] [field] [fast]
+	static int RunLive(const int argc, char** argv);
+
+	// Re-executes a journal recorded by --live single-threaded, as fast as
+	// possible, and prints the outcome and handler latencies.
+	// Usage: --replay <journal> [container type]
+	static int RunReplay(const int argc, char** argv);
+
+	// Generates an asteroid field file for --headless and --live.
+	// Usage: --make-field <field> <asteroids> [seed]
+	static int RunMakeField(const int argc, char** argv);
+};
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
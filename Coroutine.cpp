@@ -0,0 +1,113 @@
+// ================================================ //
+// File: Coroutine.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements TimerAwaiter and ChannelAwaiter classes.
+// ================================================ //
+
+#include "Coroutine.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+#include "Channel.hpp"
+#include "TimerWheel.hpp"
+
+// ================================================ //
+
+TimerAwaiter::TimerAwaiter(TimerWheel* wheel, const Uint delay) :
+m_wheel(wheel),
+m_delay(delay)
+{
+
+}
+
+// ================================================ //
+
+bool TimerAwaiter::await_ready(void) const
+{
+	return false;
+}
+
+// ================================================ //
+
+void TimerAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	m_wheel->schedule(m_delay, [handle](){ handle.resume(); });
+}
+
+// ================================================ //
+
+void TimerAwaiter::await_resume(void) const
+{
+
+}
+
+// ================================================ //
+
+ChannelAwaiter::ChannelAwaiter(TimerWheel* wheel, Channel* channel,
+							   const Uint interval) :
+m_wheel(wheel),
+m_channel(channel),
+m_interval(interval),
+m_handle(),
+m_claimed(false)
+{
+
+}
+
+// ================================================ //
+
+bool ChannelAwaiter::await_ready(void) const
+{
+	return m_channel->poll();
+}
+
+// ================================================ //
+
+bool ChannelAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	m_handle = handle;
+	if (m_channel->notifyWhenReady([this](){ this->ready(); }) == false){
+		m_wheel->schedule(m_interval, [this](){ this->check(); });
+		return true;
+	}
+
+	// Once ready() has run, the coroutine may be resumed and this awaiter
+	// gone, so nothing here touches it after the exchange.
+	return (m_claimed.exchange(true) == false);
+}
+
+// ================================================ //
+
+void ChannelAwaiter::await_resume(void) const
+{
+
+}
+
+// ================================================ //
+
+void ChannelAwaiter::ready(void)
+{
+	if (m_claimed.exchange(true)){
+		m_handle.resume();
+	}
+}
+
+// ================================================ //
+
+void ChannelAwaiter::check(void)
+{
+	if (m_channel->poll()){
+		m_handle.resume();
+	}
+	else{
+		m_wheel->schedule(m_interval, [this](){ this->check(); });
+	}
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,122 @@
+// ================================================ //
+// File: Coroutine.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Coroutine, TimerAwaiter and ChannelAwaiter classes.
+// ================================================ //
+
+#ifndef __COROUTINE_HPP__
+#define __COROUTINE_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// Coroutines need a C++20 compiler; without one probes fall back to
+// Probe::step() on the wheel.
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+
+class Channel;
+class TimerWheel;
+
+// ================================================ //
+// Return type of a coroutine which starts at once and runs to completion
+// on its own, resumed by whatever it awaits. Nothing holds on to it; the
+// frame frees itself when the body returns.
+class Coroutine
+{
+public:
+	struct promise_type{
+		Coroutine get_return_object(void){
+			return Coroutine();
+		}
+
+		std::suspend_never initial_suspend(void){
+			return std::suspend_never();
+		}
+
+		std::suspend_never final_suspend(void) noexcept{
+			return std::suspend_never();
+		}
+
+		void return_void(void){
+
+		}
+
+		void unhandled_exception(void){
+			std::terminate();
+		}
+	};
+};
+
+// ================================================ //
+// Awaits delay ms on a TimerWheel, resuming on one of its workers.
+class TimerAwaiter
+{
+public:
+	explicit TimerAwaiter(TimerWheel* wheel, const Uint delay);
+
+	// Always suspends, so every step goes back through the wheel.
+	bool await_ready(void) const;
+
+	// Schedules the coroutine's resumption.
+	void await_suspend(std::coroutine_handle<> handle);
+
+	void await_resume(void) const;
+
+private:
+	TimerWheel* m_wheel;
+	Uint m_delay;
+};
+
+// ================================================ //
+// Awaits a channel becoming readable (see Channel::poll()). The coroutine
+// is resumed by the channel itself (see Channel::notifyWhenReady()), on
+// whichever thread delivers the message, so a reply costs no timer and no
+// added latency. A channel which can't notify is checked every interval ms
+// on a TimerWheel instead. A channel that has closed counts as readable,
+// so receive() then reports it.
+class ChannelAwaiter
+{
+public:
+	explicit ChannelAwaiter(TimerWheel* wheel, Channel* channel,
+							const Uint interval);
+
+	// Returns true if the channel is readable already.
+	bool await_ready(void) const;
+
+	// Asks the channel to resume the coroutine once readable. Returns false,
+	// so the coroutine carries straight on, if that happened already.
+	bool await_suspend(std::coroutine_handle<> handle);
+
+	void await_resume(void) const;
+
+private:
+	// Called by the channel once readable. Of this and the end of
+	// await_suspend(), whichever runs second resumes the coroutine; if it
+	// is await_suspend(), it does so by not suspending.
+	void ready(void);
+
+	// Resumes the coroutine if the channel is readable, otherwise checks
+	// again after m_interval. The awaiter lives in the suspended frame, so
+	// it outlasts every check.
+	void check(void);
+
+	TimerWheel* m_wheel;
+	Channel* m_channel;
+	Uint m_interval;
+	std::coroutine_handle<> m_handle;
+	std::atomic<bool> m_claimed;
+};
+
+// ================================================ //
+
+#endif
+
+#endif
+
+// ================================================ //
@@ -13,6 +13,12 @@
 
 #include "stdafx.hpp"
 
+// Common controls, used only by the Win32 front end.
+#include <CommCtrl.h>
+#include <commdlg.h>
+#include <Shlwapi.h>
+#include <ShlObj.h>
+
 // ================================================ //
 
 // Inserts a new item into listview.
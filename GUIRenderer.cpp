@@ -0,0 +1,281 @@
+// ================================================ //
+// File: GUIRenderer.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements GUIRenderer class.
+// ================================================ //
+
+#include "GUIRenderer.hpp"
+#include "GUI.hpp"
+#include "resource.h"
+
+// ================================================ //
+
+GUIRenderer::GUIRenderer(const HWND hwnd, TFC* tfc) :
+m_hwnd(hwnd),
+m_tfc(tfc),
+m_rows(),
+m_found(),
+m_net(),
+m_removing(false),
+m_probesLost(),
+m_log(),
+m_countsChanged(false),
+m_shieldsChanged(false),
+m_fleetStatus(GUIEventType::NONE),
+m_lastFrame(std::chrono::steady_clock::now()),
+m_elapsed(true)
+{
+
+}
+
+// ================================================ //
+
+GUIRenderer::~GUIRenderer(void)
+{
+
+}
+
+// ================================================ //
+
+void GUIRenderer::apply(const GUIEvent& e)
+{
+	switch (e.type){
+	default:
+	case GUIEventType::NONE:
+		break;
+
+	case GUIEventType::ASTEROID_FOUND:
+		m_found.push_back(e.asteroid);
+		++m_net[e.asteroid.id];
+		m_log.push_back("Asteroid " + toString(e.asteroid.id) + " discovered.");
+		break;
+
+	case GUIEventType::ASTEROID_REMOVED:
+		// e.x holds the ID.
+		if (--m_net[e.x] < 0){
+			m_removing = true;
+		}
+		m_countsChanged = true;
+		m_log.push_back("Asteroid " + toString(e.x) + " removed from queue.");
+		break;
+
+	case GUIEventType::ASTEROID_DESTROYED:
+		m_countsChanged = true;
+		m_log.push_back("Asteroid " + toString(e.x) + " destroyed by probe " + 
+						toString(e.id));
+		break;
+
+	case GUIEventType::ASTEROID_COLLISION:
+		m_shieldsChanged = true;
+		m_log.push_back("Asteroid " + toString(e.id) + " collided with TFC!");
+		break;
+
+	case GUIEventType::PROBE_TERMINATED:
+		m_probesLost.push_back(static_cast<Uint>(e.id));
+		m_log.push_back("Probe " + toString(e.id) + " lost to asteroid " +
+						toString(e.x) + "!");
+		break;
+
+	case GUIEventType::FLEET_DESTROYED:
+		m_fleetStatus = e.type;
+		m_log.push_back("Fleet destroyed!");
+		break;
+
+	case GUIEventType::FLEET_SURVIVED:
+		m_fleetStatus = e.type;
+		m_countsChanged = true;
+		m_log.push_back("Fleet arrived!");
+		break;
+	}
+}
+
+// ================================================ //
+
+void GUIRenderer::render(const bool force)
+{
+	if (force == false && this->getTimeToNextFrame() > 0){
+		return;
+	}
+	m_lastFrame = std::chrono::steady_clock::now();
+
+	this->renderAsteroids();
+
+	if (m_countsChanged){
+		this->renderCounts();
+		m_countsChanged = false;
+	}
+
+	if (m_shieldsChanged){
+		// Link progress bar to shield power.
+		Uint shields = m_tfc->getShields();
+		SendDlgItemMessage(m_hwnd, IDC_PROGRESS_SHIELDS, PBM_SETPOS,
+						   static_cast<WPARAM>(shields), 0);
+
+		// Update number of hits on shields.
+		std::string buffer = "Shields (Hits: " + toString(5 - shields) + ")";
+		SetDlgItemText(m_hwnd, IDC_STATIC_SHIELDS, buffer.c_str());
+		m_shieldsChanged = false;
+	}
+
+	if (m_probesLost.empty() == false){
+		// Probes are few and rarely lost, a search is fine here.
+		HWND hList = GetDlgItem(m_hwnd, IDC_LIST_PROBES);
+		for (std::vector<Uint>::iterator itr = m_probesLost.begin(); 
+			 itr != m_probesLost.end(); ++itr){
+			int index = GetListviewItemIndex(hList, 0, toString(*itr));
+			if (index != -1){
+				SendMessage(hList, LVM_DELETEITEM, static_cast<WPARAM>(index), 0);
+			}
+		}
+		m_probesLost.clear();
+
+		// Update number of probes.
+		std::string buffer = "Launched Probes (Count: " +
+			toString(m_tfc->getNumProbes()) + ")";
+		SetDlgItemText(m_hwnd, IDC_STATIC_LIST_PROBES_TITLE, buffer.c_str());
+	}
+
+	this->renderLog();
+
+	// Update elapsed time every one second.
+	if (m_tfc->isInAsteroidField() && m_elapsed.getTicks() > 1000){
+		Uint time = m_tfc->getCurrentTime() / 1000;
+		std::string buf("Elapsed Time: " + toString(time));
+		SetDlgItemText(m_hwnd, IDC_STATIC_TIME, buf.c_str());
+		m_elapsed.restart();
+	}
+
+	// Report the outcome last, the message box blocks until dismissed.
+	if (m_fleetStatus == GUIEventType::FLEET_DESTROYED){
+		SetDlgItemText(m_hwnd, IDC_STATIC_STATUS, "Fleet Status: Destroyed");
+		std::string msg = "The fleet has been destroyed.\r\n\r\n" +
+			toString(m_tfc->getNumPhaserProbesLaunched()) + " phaser probes used.";
+		m_fleetStatus = GUIEventType::NONE;
+		MessageBox(m_hwnd, msg.c_str(), "Failure",
+				   MB_OK | MB_ICONWARNING | MB_SETFOREGROUND);
+	}
+	else if (m_fleetStatus == GUIEventType::FLEET_SURVIVED){
+		SetDlgItemText(m_hwnd, IDC_STATIC_STATUS, "Fleet Status: Arrived");
+		std::string msg = "The fleet successfully nagivated the asteroid field"
+			" and has arrived at Talos IV!\r\n\r\n" + 
+			toString(m_tfc->getNumPhaserProbesLaunched()) + " phaser probes used.";
+		m_fleetStatus = GUIEventType::NONE;
+		MessageBox(m_hwnd, msg.c_str(), "Success",
+				   MB_OK | MB_ICONINFORMATION | MB_SETFOREGROUND);
+	}
+
+	UpdateWindow(m_hwnd);
+}
+
+// ================================================ //
+
+void GUIRenderer::renderAsteroids(void)
+{
+	if (m_net.empty()){
+		return;
+	}
+
+	HWND hList = GetDlgItem(m_hwnd, IDC_LIST_ASTEROIDS);
+	SendMessage(hList, WM_SETREDRAW, FALSE, 0);
+
+	if (m_removing){
+		// Take one listed row, oldest first, for each removal left over
+		// once this frame's finds are netted out.
+		std::vector<int> rows;
+		std::vector<uint64_t> kept;
+		kept.reserve(m_rows.size());
+		for (Uint i = 0; i < m_rows.size(); ++i){
+			std::unordered_map<uint64_t, int>::iterator net = m_net.find(m_rows[i]);
+			if (net != m_net.end() && net->second < 0){
+				++net->second;
+				rows.push_back(static_cast<int>(i));
+			}
+			else{
+				kept.push_back(m_rows[i]);
+			}
+		}
+
+		// Delete from the bottom up so earlier rows keep their index.
+		for (std::vector<int>::reverse_iterator itr = rows.rbegin(); itr != rows.rend(); ++itr){
+			SendMessage(hList, LVM_DELETEITEM, static_cast<WPARAM>(*itr), 0);
+		}
+		m_rows.swap(kept);
+		m_removing = false;
+	}
+
+	for (std::vector<Asteroid>::iterator itr = m_found.begin(); itr != m_found.end(); ++itr){
+		std::unordered_map<uint64_t, int>::iterator net = m_net.find(itr->id);
+		if (net->second <= 0){
+			// Found and removed again within the frame.
+			continue;
+		}
+		--net->second;
+
+		// Insert asteroid data into listview.
+		int row = static_cast<int>(m_rows.size());
+		InsertListviewItem(hList, row, toString(itr->id));
+		SetListviewItem(hList, row, 1, toString(itr->mass));
+		m_rows.push_back(itr->id);
+	}
+	m_found.clear();
+	m_net.clear();
+
+	SendMessage(hList, WM_SETREDRAW, TRUE, 0);
+	InvalidateRect(hList, nullptr, TRUE);
+
+	// Update number of asteroids in stack.
+	std::string buffer = "Asteroids (Count: " + toString(m_rows.size()) + ")";
+	SetDlgItemText(m_hwnd, IDC_STATIC_LIST_ASTEROIDS_TITLE, buffer.c_str());
+}
+
+// ================================================ //
+
+void GUIRenderer::renderLog(void)
+{
+	if (m_log.empty()){
+		return;
+	}
+
+	HWND hLog = GetDlgItem(m_hwnd, IDC_LIST_TFC_UPDATES);
+	SendMessage(hLog, WM_SETREDRAW, FALSE, 0);
+	for (std::vector<std::string>::iterator itr = m_log.begin(); itr != m_log.end(); ++itr){
+		SendMessage(hLog, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(itr->c_str()));
+	}
+	m_log.clear();
+
+	// Scroll to last message.
+	int count = static_cast<int>(SendMessage(hLog, LB_GETCOUNT, 0, 0));
+	SendMessage(hLog, LB_SETCURSEL, static_cast<WPARAM>(count - 1), 0);
+	SendMessage(hLog, WM_SETREDRAW, TRUE, 0);
+	InvalidateRect(hLog, nullptr, TRUE);
+}
+
+// ================================================ //
+
+void GUIRenderer::renderCounts(void)
+{
+	// Update asteroids awaiting destruction.
+	std::string buffer = "Asteroids Awaiting Destruction: " + 
+		toString(m_tfc->getNumAsteroidsAwaitingDestruction());
+	SetDlgItemText(m_hwnd, IDC_STATIC_NUMASTEROIDS, buffer.c_str());
+
+	// Update asteroids destroyed.
+	buffer = "Asteroids Successfully Destroyed: " +
+		toString(m_tfc->getNumAsteroidsDestroyed());
+	SetDlgItemText(m_hwnd, IDC_STATIC_ASTEROIDS_DESTROYED, buffer.c_str());
+}
+
+// ================================================ //
+
+const Uint GUIRenderer::getTimeToNextFrame(void) const
+{
+	using namespace std::chrono;
+	int64_t elapsed = duration_cast<milliseconds>(steady_clock::now() - m_lastFrame).count();
+	int64_t interval = 1000 / GUIRenderer::FrameRate;
+
+	return (elapsed >= interval) ? 0 : static_cast<Uint>(interval - elapsed);
+}
+
+// ================================================ //
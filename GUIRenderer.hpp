@@ -0,0 +1,86 @@
+// ================================================ //
+// File: GUIRenderer.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines GUIRenderer class.
+// ================================================ //
+
+#ifndef __GUIRENDERER_HPP__
+#define __GUIRENDERER_HPP__
+
+// ================================================ //
+
+#include "TFC.hpp"
+#include <unordered_map>
+
+// ================================================ //
+// Presents TFC events in the main window at a fixed frame rate. Events are
+// folded into pending changes as they arrive and written to the controls
+// at most FrameRate times a second, so a burst of events costs one redraw
+// of each control rather than one per event. Finds and removals of an
+// asteroid within a frame are netted per ID, so one found and removed
+// again never reaches the listview, and rows are matched to removals in
+// one pass instead of searching the listview.
+class GUIRenderer
+{
+public:
+	// Renders into the main dialog hwnd, reading totals from tfc.
+	explicit GUIRenderer(const HWND hwnd, TFC* tfc);
+
+	// Empty destructor.
+	~GUIRenderer(void);
+
+	// Folds an event into the changes pending for the next frame.
+	void apply(const GUIEvent& e);
+
+	// Writes pending changes to the window if a frame is due, or always if
+	// force is true.
+	void render(const bool force = false);
+
+	// Getters
+
+	// Returns ms until the next frame is due.
+	const Uint getTimeToNextFrame(void) const;
+
+	// --- //
+
+	// Frames per second.
+	static const Uint FrameRate = 30;
+
+private:
+	// Deletes removed rows and appends found ones to the asteroid listview.
+	void renderAsteroids(void);
+
+	// Appends pending lines to the TFC log and scrolls to the last.
+	void renderLog(void);
+
+	// Updates the asteroid totals.
+	void renderCounts(void);
+
+	HWND m_hwnd;
+	TFC* m_tfc;
+	// Asteroid IDs in listview row order.
+	std::vector<uint64_t> m_rows;
+	// Asteroids found since the last frame.
+	std::vector<Asteroid> m_found;
+	// Per asteroid ID, times found less times removed since the last frame.
+	std::unordered_map<uint64_t, int> m_net;
+	// Set once m_net goes negative for any ID this frame.
+	bool m_removing;
+	// IDs of probes lost since the last frame.
+	std::vector<Uint> m_probesLost;
+	std::vector<std::string> m_log;
+	bool m_countsChanged, m_shieldsChanged;
+	// FLEET_DESTROYED or FLEET_SURVIVED once received, else NONE.
+	Uint m_fleetStatus;
+	std::chrono::steady_clock::time_point m_lastFrame;
+	// Used to update elapsed time every second.
+	Timer m_elapsed;
+};
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,24 @@
+// ================================================ //
+// File: Headless.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines main() for the portable command line build,
+// which has no GUI.
+// ================================================ //
+
+#include "Console.hpp"
+
+// ================================================ //
+
+int main(int argc, char** argv)
+{
+	if (Console::Handles(argc, argv) == false){
+		Console::PrintUsage(stderr);
+		return 1;
+	}
+
+	return Console::Run(argc, argv);
+}
+
+// ================================================ //
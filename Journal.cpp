@@ -0,0 +1,261 @@
+// ================================================ //
+// File: Journal.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements Journal class.
+// ================================================ //
+
+#include "Journal.hpp"
+#include "LatencyHistogram.hpp"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+// ================================================ //
+
+// Identifies a journal file of this record layout.
+static const uint32_t Magic = 0x4C324A4E;
+
+struct Journal::Header{
+	uint32_t magic;
+	uint32_t recordSize;
+	// Records in the file, written by close(). Zero if the writer never
+	// closed it, in which case the file size decides.
+	uint64_t count;
+	char pad[CACHE_LINE_SIZE - 2 * sizeof(uint32_t) - sizeof(uint64_t)];
+};
+
+// ================================================ //
+
+Journal::Journal(void) :
+m_fd(-1),
+m_base(nullptr),
+m_mapped(0),
+m_header(nullptr),
+m_records(nullptr),
+m_maxRecords(0),
+m_next(0),
+m_capacity(0),
+m_dropped(0),
+m_writers(0),
+m_closed(true),
+m_growMutex(),
+m_count(0),
+m_writable(false)
+{
+
+}
+
+// ================================================ //
+
+Journal::~Journal(void)
+{
+	this->close();
+}
+
+// ================================================ //
+
+bool Journal::create(const std::string& path, const Uint maxRecords)
+{
+#if !defined(_WIN32)
+	this->close();
+
+	m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_fd < 0){
+		return false;
+	}
+
+	// Reserve address space for every record up front so the mapping never
+	// moves; the file behind it grows as slots are claimed.
+	m_mapped = sizeof(Header) + static_cast<size_t>(maxRecords) * sizeof(Record);
+	void* p = mmap(nullptr, m_mapped, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (p == MAP_FAILED || ftruncate(m_fd, sizeof(Header)) != 0){
+		if (p != MAP_FAILED){
+			munmap(p, m_mapped);
+		}
+		m_mapped = 0;
+		this->release();
+		return false;
+	}
+
+	m_base = static_cast<char*>(p);
+	m_header = reinterpret_cast<Header*>(m_base);
+	m_records = reinterpret_cast<Record*>(m_base + sizeof(Header));
+	m_header->magic = Magic;
+	m_header->recordSize = sizeof(Record);
+	m_header->count = 0;
+
+	m_maxRecords = maxRecords;
+	m_next = 0;
+	m_capacity = 0;
+	m_dropped = 0;
+	m_count = 0;
+	m_writable = true;
+	m_closed = false;
+
+	return true;
+#else
+	(void)path;
+	(void)maxRecords;
+	return false;
+#endif
+}
+
+// ================================================ //
+
+bool Journal::open(const std::string& path)
+{
+#if !defined(_WIN32)
+	this->close();
+
+	m_fd = ::open(path.c_str(), O_RDONLY);
+	if (m_fd < 0){
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(m_fd, &info) != 0 ||
+		info.st_size < static_cast<off_t>(sizeof(Header))){
+		this->release();
+		return false;
+	}
+
+	m_mapped = static_cast<size_t>(info.st_size);
+	void* p = mmap(nullptr, m_mapped, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if (p == MAP_FAILED){
+		m_mapped = 0;
+		this->release();
+		return false;
+	}
+
+	m_base = static_cast<char*>(p);
+	m_header = reinterpret_cast<Header*>(m_base);
+	m_records = reinterpret_cast<Record*>(m_base + sizeof(Header));
+	if (m_header->magic != Magic || m_header->recordSize != sizeof(Record)){
+		this->release();
+		return false;
+	}
+
+	// A journal whose writer died has no count; take whatever whole
+	// records made it to the file. Unwritten slots read as NONE.
+	uint64_t count = (m_mapped - sizeof(Header)) / sizeof(Record);
+	if (m_header->count != 0 && m_header->count < count){
+		count = m_header->count;
+	}
+	m_count = static_cast<Uint>(count);
+
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+// ================================================ //
+
+void Journal::append(const Uint type, const Uint probeID, const Uint probeType,
+					 const Uint tick, const Probe::Message* msg)
+{
+	// Announce the write before checking m_closed, so close() either sees
+	// it and waits, or it sees m_closed and backs out.
+	m_writers.fetch_add(1);
+	if (m_closed == false){
+		Uint i = m_next.fetch_add(1, std::memory_order_relaxed);
+		if (i < m_maxRecords &&
+			(i < m_capacity.load(std::memory_order_acquire) || this->grow(i))){
+			Record& r = m_records[i];
+			r.probeID = probeID;
+			r.probeType = probeType;
+			r.tick = tick;
+			r.wallTime = Telemetry::Now();
+			if (msg != nullptr){
+				r.msg = *msg;
+			}
+			// Last, so a slot is either NONE or complete.
+			r.type = type;
+		}
+		else{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	else{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+	m_writers.fetch_sub(1);
+}
+
+// ================================================ //
+
+void Journal::close(void)
+{
+	if (m_writable){
+		m_closed = true;
+		while (m_writers != 0){
+			std::this_thread::yield();
+		}
+
+		m_count = std::min(std::min(m_next.load(), m_maxRecords), m_capacity.load());
+		m_header->count = m_count;
+#if !defined(_WIN32)
+		// Drop the unclaimed tail of the last growth.
+		if (ftruncate(m_fd, sizeof(Header) + static_cast<off_t>(m_count) * sizeof(Record)) != 0){
+			fprintf(stderr, "Journal: failed to trim file.\n");
+		}
+#endif
+		m_writable = false;
+	}
+
+	this->release();
+}
+
+// ================================================ //
+
+bool Journal::grow(const Uint i)
+{
+#if !defined(_WIN32)
+	std::lock_guard<std::mutex> lock(m_growMutex);
+	Uint capacity = m_capacity.load(std::memory_order_relaxed);
+	if (i < capacity){
+		// Another writer grew it first.
+		return true;
+	}
+
+	Uint target = std::min(m_maxRecords, (i / GrowRecords + 1) * GrowRecords);
+	off_t size = sizeof(Header) + static_cast<off_t>(target) * sizeof(Record);
+	if (ftruncate(m_fd, size) != 0){
+		return false;
+	}
+
+	m_capacity.store(target, std::memory_order_release);
+	return true;
+#else
+	(void)i;
+	return false;
+#endif
+}
+
+// ================================================ //
+
+void Journal::release(void)
+{
+#if !defined(_WIN32)
+	if (m_base != nullptr){
+		munmap(m_base, m_mapped);
+	}
+	if (m_fd >= 0){
+		::close(m_fd);
+	}
+#endif
+	m_base = nullptr;
+	m_mapped = 0;
+	m_header = nullptr;
+	m_records = nullptr;
+	m_fd = -1;
+	m_closed = true;
+}
+
+// ================================================ //
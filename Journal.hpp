@@ -0,0 +1,163 @@
+// ================================================ //
+// File: Journal.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Journal class.
+// ================================================ //
+
+#ifndef __JOURNAL_HPP__
+#define __JOURNAL_HPP__
+
+// ================================================ //
+
+#include "Probe.hpp"
+
+// ================================================ //
+// Append-only binary log of everything the TFC was asked to do and what it
+// decided, so a run can be re-executed offline and checked (see Replay).
+// The file is a short header and an array of fixed-size records, memory
+// mapped: a writer claims the next slot with one atomic increment and
+// fills it in place, so any number of probe handlers can append at once
+// without a lock or a system call, bar growing the file every GrowRecords
+// records. Slots are claimed in the order handlers reach the TFC, and
+// messages which touch the asteroid container are only recorded once the
+// TFC holds it, so the journal has them in the order they changed it.
+// Needs POSIX mmap(); elsewhere create() and open() fail.
+class Journal
+{
+public:
+	// What a record holds.
+	enum RecordType{
+		// Unused slot, left by a writer which never finished.
+		NONE = 0,
+		// A probe was registered (see TFC::registerProbe()).
+		LAUNCH,
+		// The TFC entered the asteroid field; TFC time restarts at zero.
+		FIELD_ENTERED,
+		// A message from a probe was handled (see TFC::handleMessage()).
+		MESSAGE,
+		// The TFC's answer to the probe's last DEFENSIVE_REQUEST or
+		// DEFENSIVE_BATCH_REQUEST: msg is the TARGETS_AVAILABLE or NO_TARGET
+		// reply, always in batch form.
+		TARGETS,
+		// An asteroid hit the fleet, either expiring in the container or
+		// finding no room in it; msg.asteroid is the asteroid.
+		COLLISION,
+		// The TFC left the asteroid field with the fleet intact, or
+		// destroyed.
+		FLEET_SURVIVED,
+		FLEET_DESTROYED
+	};
+
+	struct Record{
+		// See Journal::RecordType.
+		uint32_t type;
+		// ID and type the live TFC gave the probe.
+		uint32_t probeID;
+		uint32_t probeType;
+		// TFC time when the record was made (ms).
+		uint32_t tick;
+		// Wall clock time when the record was made (ns, see Telemetry::Now()).
+		int64_t wallTime;
+		// The message, for MESSAGE records.
+		Probe::Message msg;
+	};
+
+	// Creates an unopened journal.
+	explicit Journal(void);
+
+	// Closes the journal.
+	~Journal(void);
+
+	// Creates the file at path, replacing any there, for appending. Space
+	// for up to maxRecords is reserved; appends past it are dropped.
+	// Returns false on failure.
+	bool create(const std::string& path, const Uint maxRecords = DefaultMaxRecords);
+
+	// Maps the journal at path read-only for replaying. Returns false if
+	// it can't be read or is not a journal.
+	bool open(const std::string& path);
+
+	// Appends a record; msg may be null. Safe to call from any thread.
+	void append(const Uint type, const Uint probeID, const Uint probeType,
+				const Uint tick, const Probe::Message* msg = nullptr);
+
+	// Waits for appends in progress, writes the record count and trims the
+	// file to the records written. Later appends are dropped. Safe to call
+	// more than once.
+	void close(void);
+
+	// Getters
+
+	// Returns the number of record slots, once closed or opened.
+	const Uint getCount(void) const;
+
+	// Returns record i, which may be of type NONE. Only valid once opened.
+	const Record& getRecord(const Uint i) const;
+
+	// Returns the number of appends dropped because the journal was full,
+	// closed, or could not grow.
+	const Uint getDropped(void) const;
+
+	// --- //
+
+	// Records reserved by default, about 700 MB of address space.
+	static const Uint DefaultMaxRecords = 1 << 22;
+
+	// Records the file grows by at a time.
+	static const Uint GrowRecords = 4096;
+
+private:
+	// Not copyable.
+	Journal(const Journal&);
+	Journal& operator=(const Journal&);
+
+	struct Header;
+
+	// Extends the file to cover slot i. Returns false on failure.
+	bool grow(const Uint i);
+
+	// Unmaps and closes the file.
+	void release(void);
+
+	int m_fd;
+	char* m_base;
+	size_t m_mapped;
+	Header* m_header;
+	Record* m_records;
+	Uint m_maxRecords;
+	// Slots claimed so far; may run past m_maxRecords while dropping.
+	std::atomic<Uint> m_next;
+	// Slots the file currently covers.
+	std::atomic<Uint> m_capacity;
+	std::atomic<Uint> m_dropped;
+	// Appends in progress, drained by close().
+	std::atomic<Uint> m_writers;
+	std::atomic<bool> m_closed;
+	std::mutex m_growMutex;
+	Uint m_count;
+	bool m_writable;
+};
+
+// ================================================ //
+
+// Getters
+
+inline const Uint Journal::getCount(void) const{
+	return m_count;
+}
+
+inline const Journal::Record& Journal::getRecord(const Uint i) const{
+	return m_records[i];
+}
+
+inline const Uint Journal::getDropped(void) const{
+	return m_dropped;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
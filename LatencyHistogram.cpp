@@ -0,0 +1,198 @@
+// ================================================ //
+// File: LatencyHistogram.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements LatencyHistogram and Telemetry classes.
+// ================================================ //
+
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+// ================================================ //
+
+LatencyHistogram Telemetry::Histograms[Telemetry::MaxProbeType]
+	[Telemetry::MaxMessageType][Telemetry::NUM_PHASES];
+
+// ================================================ //
+
+LatencyHistogram::LatencyHistogram(void)
+{
+	this->reset();
+}
+
+// ================================================ //
+
+LatencyHistogram::~LatencyHistogram(void)
+{
+
+}
+
+// ================================================ //
+
+void LatencyHistogram::record(const int64_t ns)
+{
+	uint64_t value = (ns > 0) ? static_cast<uint64_t>(ns) : 0;
+
+	m_buckets[LatencyHistogram::BucketIndex(value)].fetch_add(1,
+		std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(value, std::memory_order_relaxed);
+
+	int64_t max = m_max.load(std::memory_order_relaxed);
+	while (static_cast<int64_t>(value) > max &&
+		   m_max.compare_exchange_weak(max, value, std::memory_order_relaxed) == false);
+}
+
+// ================================================ //
+
+void LatencyHistogram::reset(void)
+{
+	for (Uint i = 0; i < NumBuckets; ++i){
+		m_buckets[i].store(0, std::memory_order_relaxed);
+	}
+	m_count.store(0, std::memory_order_relaxed);
+	m_sum.store(0, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+// ================================================ //
+
+const double LatencyHistogram::getMean(void) const
+{
+	uint64_t count = this->getCount();
+	return (count > 0) ?
+		static_cast<double>(m_sum.load(std::memory_order_relaxed)) / count : 0.0;
+}
+
+// ================================================ //
+
+const int64_t LatencyHistogram::getPercentile(const double percentile) const
+{
+	uint64_t count = this->getCount();
+	if (count == 0){
+		return 0;
+	}
+
+	// Rank of the sample wanted, counting from one.
+	double p = std::min(std::max(percentile, 0.0), 100.0);
+	uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * count));
+	rank = std::max<uint64_t>(rank, 1);
+
+	uint64_t seen = 0;
+	for (Uint i = 0; i < NumBuckets; ++i){
+		seen += m_buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank){
+			// The bucket edge can overshoot the largest sample.
+			return std::min<int64_t>(LatencyHistogram::BucketLimit(i),
+									 this->getMax());
+		}
+	}
+
+	return this->getMax();
+}
+
+// ================================================ //
+
+const Uint LatencyHistogram::BucketIndex(const uint64_t value)
+{
+	if (value < SubBuckets){
+		return static_cast<Uint>(value);
+	}
+
+	// Position of the highest set bit.
+	Uint msb = 0;
+	uint64_t v = value;
+	for (Uint step = 32; step > 0; step /= 2){
+		if (v >> step){
+			v >>= step;
+			msb += step;
+		}
+	}
+
+	// SubBuckets is 2^4, so the four bits below the highest pick the
+	// linear step within this power of two.
+	Uint shift = msb - 4;
+	Uint index = (shift + 1) * SubBuckets +
+		static_cast<Uint>(value >> shift) - SubBuckets;
+
+	return std::min<Uint>(index, NumBuckets - 1);
+}
+
+// ================================================ //
+
+const uint64_t LatencyHistogram::BucketLimit(const Uint index)
+{
+	if (index < SubBuckets){
+		return index;
+	}
+
+	Uint shift = index / SubBuckets - 1;
+	uint64_t lower = static_cast<uint64_t>(SubBuckets + index % SubBuckets) << shift;
+
+	return lower + (static_cast<uint64_t>(1) << shift) - 1;
+}
+
+// ================================================ //
+
+LatencyHistogram& Telemetry::Get(const Uint probeType, const Uint msgType,
+								 const Phase phase)
+{
+	return Histograms[(probeType < MaxProbeType) ? probeType : 0]
+		[(msgType < MaxMessageType) ? msgType : 0][phase];
+}
+
+// ================================================ //
+
+void Telemetry::Print(FILE* out)
+{
+	static const char* probeNames[MaxProbeType] = {
+		"-", "scout", "photon", "phaser"
+	};
+	// Indexed by Probe::MessageType; unused slots read "-".
+	static const char* msgNames[MaxMessageType] = {
+		"-", "launch", "confirm", "scout req", "defend req", "found",
+		"target", "no target", "destroyed", "terminated", "batch found",
+		"batch req", "targets", "-", "-", "-"
+	};
+	static const char* phaseNames[NUM_PHASES] = {
+		"round trip", "service", "sem wait", "network"
+	};
+
+	fprintf(out, "%7s %11s %10s %9s %10s %10s %10s %10s %10s %10s\n", "probe", "msg",
+			"phase", "count", "mean(us)", "p50(us)", "p90(us)", "p99(us)",
+			"p99.9(us)", "max(us)");
+	for (Uint p = 0; p < MaxProbeType; ++p){
+		for (Uint m = 0; m < MaxMessageType; ++m){
+			for (Uint ph = 0; ph < NUM_PHASES; ++ph){
+				const LatencyHistogram& h = Histograms[p][m][ph];
+				if (h.getCount() == 0){
+					continue;
+				}
+
+				fprintf(out, "%7s %11s %10s %9llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+						probeNames[p], msgNames[m], phaseNames[ph],
+						static_cast<unsigned long long>(h.getCount()),
+						h.getMean() / 1000.0, h.getPercentile(50.0) / 1000.0,
+						h.getPercentile(90.0) / 1000.0, h.getPercentile(99.0) / 1000.0,
+						h.getPercentile(99.9) / 1000.0, h.getMax() / 1000.0);
+			}
+		}
+	}
+}
+
+// ================================================ //
+
+void Telemetry::Reset(void)
+{
+	for (Uint p = 0; p < MaxProbeType; ++p){
+		for (Uint m = 0; m < MaxMessageType; ++m){
+			for (Uint ph = 0; ph < NUM_PHASES; ++ph){
+				Histograms[p][m][ph].reset();
+			}
+		}
+	}
+}
+
+// ================================================ //
@@ -0,0 +1,147 @@
+// ================================================ //
+// File: LatencyHistogram.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines LatencyHistogram and Telemetry classes.
+// ================================================ //
+
+#ifndef __LATENCYHISTOGRAM_HPP__
+#define __LATENCYHISTOGRAM_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// ================================================ //
+// A histogram of durations in nanoseconds with bounded relative error, in
+// the manner of HdrHistogram. Buckets double in width each power of two and
+// are split into SubBuckets linear steps, so any value is placed within
+// 1/SubBuckets of its true size while the whole range from 1 ns to days
+// takes a few hundred counters. Recording is a few relaxed atomic updates
+// and may happen from any thread.
+class LatencyHistogram
+{
+public:
+	// Creates an empty histogram.
+	explicit LatencyHistogram(void);
+
+	// Empty destructor.
+	~LatencyHistogram(void);
+
+	// Adds one sample of ns nanoseconds. Negative values count as zero.
+	void record(const int64_t ns);
+
+	// Clears every sample. Not safe against concurrent record().
+	void reset(void);
+
+	// Returns number of samples recorded.
+	const uint64_t getCount(void) const;
+
+	// Returns mean of the samples in nanoseconds.
+	const double getMean(void) const;
+
+	// Returns largest sample in nanoseconds.
+	const int64_t getMax(void) const;
+
+	// Returns the value in nanoseconds at or below which percentile (0-100)
+	// of the samples fall, rounded up to the edge of its bucket.
+	const int64_t getPercentile(const double percentile) const;
+
+	// Linear steps within each power of two.
+	static const Uint SubBuckets = 16;
+	// Powers of two covered; larger values land in the last bucket.
+	static const Uint Magnitudes = 48;
+
+private:
+	// Not copyable.
+	LatencyHistogram(const LatencyHistogram&);
+	LatencyHistogram& operator=(const LatencyHistogram&);
+
+	// Returns bucket holding value.
+	static const Uint BucketIndex(const uint64_t value);
+
+	// Returns largest value held by bucket.
+	static const uint64_t BucketLimit(const Uint index);
+
+	static const Uint NumBuckets = (Magnitudes + 1) * SubBuckets;
+
+	std::atomic<uint32_t> m_buckets[NumBuckets];
+	std::atomic<uint64_t> m_count;
+	std::atomic<uint64_t> m_sum;
+	std::atomic<int64_t> m_max;
+};
+
+// ================================================ //
+
+inline const uint64_t LatencyHistogram::getCount(void) const{
+	return m_count.load(std::memory_order_relaxed);
+}
+
+inline const int64_t LatencyHistogram::getMax(void) const{
+	return m_max.load(std::memory_order_relaxed);
+}
+
+// ================================================ //
+// Process-wide latency histograms, one per probe type, message type and
+// phase of handling, so a slowdown can be pinned on the asteroid container,
+// the sockets or the scheduler.
+class Telemetry
+{
+public:
+	enum Phase{
+		// Probe: from sending a request to receiving the TFC's reply.
+		ROUND_TRIP = 0,
+		// TFC: handling a message, excluding the network.
+		SERVICE,
+		// TFC: blocked on the asteroid container's semaphores.
+		SEMAPHORE_WAIT,
+		// TFC: sending the replies to a message.
+		NETWORK,
+		NUM_PHASES
+	};
+
+	// Returns the histogram for messages of msgType from probes of
+	// probeType. Out of range types share the zero slot.
+	static LatencyHistogram& Get(const Uint probeType, const Uint msgType,
+								 const Phase phase);
+
+	// Records ns nanoseconds in the histogram given by Get().
+	static void Record(const Uint probeType, const Uint msgType,
+					   const Phase phase, const int64_t ns);
+
+	// Returns a monotonic time stamp in nanoseconds for measuring with
+	// Record().
+	static const int64_t Now(void);
+
+	// Writes count, mean and percentiles of every non-empty histogram.
+	static void Print(FILE* out);
+
+	// Clears every histogram.
+	static void Reset(void);
+
+	// Number of slots for probe and message types.
+	static const Uint MaxProbeType = 4;
+	static const Uint MaxMessageType = 16;
+
+private:
+	static LatencyHistogram Histograms[MaxProbeType][MaxMessageType][NUM_PHASES];
+};
+
+// ================================================ //
+
+inline void Telemetry::Record(const Uint probeType, const Uint msgType,
+							  const Phase phase, const int64_t ns){
+	Telemetry::Get(probeType, msgType, phase).record(ns);
+}
+
+inline const int64_t Telemetry::Now(void){
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
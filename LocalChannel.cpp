@@ -0,0 +1,285 @@
+// ================================================ //
+// File: LocalChannel.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements LocalChannel class.
+// ================================================ //
+
+#include "LocalChannel.hpp"
+
+// ================================================ //
+
+// Idle message buffers kept for reuse across all channels.
+static const Uint PoolSize = 4096;
+
+// ================================================ //
+
+LocalChannel::Direction::Direction(void) :
+queue(LocalChannel::Capacity),
+count(0),
+callback(),
+onReady(false),
+waiterMutex(),
+waiter(),
+waiting(false)
+{
+
+}
+
+// ================================================ //
+
+LocalChannel::Link::Link(void) :
+closed(false)
+{
+
+}
+
+// ================================================ //
+
+void LocalChannel::CreatePair(std::unique_ptr<LocalChannel>& first,
+							  std::unique_ptr<LocalChannel>& second)
+{
+	std::shared_ptr<Link> link(new Link());
+	first.reset(new LocalChannel(link, 0));
+	second.reset(new LocalChannel(link, 1));
+}
+
+// ================================================ //
+
+LocalChannel::LocalChannel(const std::shared_ptr<Link>& link, const Uint side) :
+m_link(link),
+m_side(side)
+{
+
+}
+
+// ================================================ //
+
+LocalChannel::~LocalChannel(void)
+{
+	this->disconnect();
+
+	// Return anything left unread to the pool.
+	Probe::Message* msg = nullptr;
+	while (m_link->ways[1 - m_side].queue.pop(msg)){
+		LocalChannel::Release(msg);
+	}
+}
+
+// ================================================ //
+
+bool LocalChannel::send(const Probe::Message& msg)
+{
+	if (this->push(msg) == false){
+		return false;
+	}
+
+	m_link->ways[m_side].count.signal();
+	LocalChannel::Notify(m_link->ways[m_side]);
+	return true;
+}
+
+// ================================================ //
+
+bool LocalChannel::send(const std::vector<Probe::Message>& msgs)
+{
+	Uint sent = 0;
+	for (std::vector<Probe::Message>::const_iterator itr = msgs.begin();
+		 itr != msgs.end(); ++itr){
+		if (this->push(*itr) == false){
+			break;
+		}
+		++sent;
+	}
+
+	if (sent > 0){
+		m_link->ways[m_side].count.signal(sent);
+		LocalChannel::Notify(m_link->ways[m_side]);
+	}
+
+	return (sent == msgs.size());
+}
+
+// ================================================ //
+
+bool LocalChannel::receive(Probe::Message& msg)
+{
+	const Probe::Message* pMsg = this->take();
+	if (pMsg == nullptr){
+		return false;
+	}
+
+	msg = *pMsg;
+	this->release(pMsg);
+
+	return true;
+}
+
+// ================================================ //
+
+const Probe::Message* LocalChannel::take(void)
+{
+	Uint side = 1 - m_side;
+
+	// disconnect() signals as well, so an empty queue after the wait
+	// means the channel has closed.
+	m_link->ways[side].count.wait();
+
+	Probe::Message* pMsg = nullptr;
+	if (m_link->ways[side].queue.pop(pMsg) == false){
+		// Pass the wakeup on in case this end has another waiter.
+		m_link->ways[side].count.signal();
+		return nullptr;
+	}
+
+	return pMsg;
+}
+
+// ================================================ //
+
+void LocalChannel::release(const Probe::Message* msg)
+{
+	LocalChannel::Release(const_cast<Probe::Message*>(msg));
+}
+
+// ================================================ //
+
+bool LocalChannel::poll(void)
+{
+	// A message is counted only once it is in the queue.
+	return (m_link->ways[1 - m_side].count.getAvailable() > 0 || m_link->closed);
+}
+
+// ================================================ //
+
+void LocalChannel::disconnect(void)
+{
+	if (m_link->closed.exchange(true) == false){
+		for (Uint i = 0; i < 2; ++i){
+			m_link->ways[i].count.signal();
+			LocalChannel::Notify(m_link->ways[i]);
+		}
+	}
+}
+
+// ================================================ //
+
+bool LocalChannel::setReadyCallback(const std::function<void(void)>& callback)
+{
+	Direction& way = m_link->ways[1 - m_side];
+	way.callback = callback;
+	way.onReady.store(true, std::memory_order_release);
+
+	return true;
+}
+
+// ================================================ //
+
+bool LocalChannel::notifyWhenReady(const std::function<void(void)>& callback)
+{
+	Direction& way = m_link->ways[1 - m_side];
+	{
+		std::lock_guard<std::mutex> lock(way.waiterMutex);
+		way.waiter = callback;
+		way.waiting = true;
+	}
+
+	// A message sent before the sender could see the waiter would go
+	// unannounced, so look once more. Paired with the fence in Notify():
+	// either the sender sees waiting, or this sees the message.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (this->poll()){
+		LocalChannel::Wake(way);
+	}
+
+	return true;
+}
+
+// ================================================ //
+
+bool LocalChannel::push(const Probe::Message& msg)
+{
+	if (m_link->closed){
+		return false;
+	}
+
+	Probe::Message* pMsg = LocalChannel::Acquire();
+	*pMsg = msg;
+	while (m_link->ways[m_side].queue.push(pMsg) == false){
+		// Full; the receiver is behind.
+		if (m_link->closed){
+			LocalChannel::Release(pMsg);
+			return false;
+		}
+		std::this_thread::yield();
+	}
+
+	return true;
+}
+
+// ================================================ //
+
+void LocalChannel::Notify(Direction& way)
+{
+	if (way.onReady.load(std::memory_order_acquire)){
+		way.callback();
+	}
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (way.waiting.load(std::memory_order_relaxed)){
+		LocalChannel::Wake(way);
+	}
+}
+
+// ================================================ //
+
+void LocalChannel::Wake(Direction& way)
+{
+	std::function<void(void)> waiter;
+	{
+		std::lock_guard<std::mutex> lock(way.waiterMutex);
+		if (way.waiting == false){
+			// Taken by the other side.
+			return;
+		}
+		waiter.swap(way.waiter);
+		way.waiting = false;
+	}
+
+	waiter();
+}
+
+// ================================================ //
+
+// The pool is never destroyed, since detached probe threads may still be
+// sending while the process exits.
+static RingBuffer<Probe::Message*>& Pool(void)
+{
+	static RingBuffer<Probe::Message*>* pool =
+		new RingBuffer<Probe::Message*>(PoolSize);
+	return *pool;
+}
+
+// ================================================ //
+
+Probe::Message* LocalChannel::Acquire(void)
+{
+	Probe::Message* msg = nullptr;
+	if (Pool().pop(msg) == false){
+		msg = new Probe::Message;
+	}
+
+	return msg;
+}
+
+// ================================================ //
+
+void LocalChannel::Release(Probe::Message* msg)
+{
+	if (Pool().push(msg) == false){
+		delete msg;
+	}
+}
+
+// ================================================ //
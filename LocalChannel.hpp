@@ -0,0 +1,131 @@
+// ================================================ //
+// File: LocalChannel.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines LocalChannel class.
+// ================================================ //
+
+#ifndef __LOCALCHANNEL_HPP__
+#define __LOCALCHANNEL_HPP__
+
+// ================================================ //
+
+#include "Channel.hpp"
+#include "RingBuffer.hpp"
+#include "Semaphore.hpp"
+
+// ================================================ //
+// Channel between a probe and a TFC in the same process. A sent message is
+// copied once into a buffer from a shared pool and its pointer is handed
+// over through a lock-free queue; the receiver reads it in place with
+// take() and returns the buffer with release(). There is no framing and no system call unless the receiver
+// is asleep, against two copies and a send() and recv() each way for a
+// socket. Rather than block, a reader may ask to be called back when a
+// message arrives, which lets the TFC serve it as a task.
+class LocalChannel : public Channel
+{
+public:
+	// Creates two connected ends.
+	static void CreatePair(std::unique_ptr<LocalChannel>& first,
+						   std::unique_ptr<LocalChannel>& second);
+
+	// Closes the channel.
+	virtual ~LocalChannel(void);
+
+	// Hands a pooled copy of msg to the other end. Returns false if the
+	// channel is closed.
+	virtual bool send(const Probe::Message& msg);
+
+	// Hands over every message in msgs, waking the other end once.
+	virtual bool send(const std::vector<Probe::Message>& msgs);
+
+	// Blocks until a message arrives. Returns false once the channel is
+	// closed and nothing is left to read.
+	virtual bool receive(Probe::Message& msg);
+
+	// Blocks until a message arrives and returns the sender's pooled
+	// buffer itself. Returns nullptr once the channel is closed and
+	// nothing is left to read.
+	virtual const Probe::Message* take(void);
+
+	// Returns a buffer from take() to the pool.
+	virtual void release(const Probe::Message* msg);
+
+	// Returns true if a message is waiting or the channel is closed. Reads
+	// the same count receive() waits on, so it never promises a message
+	// receive() would still wait for.
+	virtual bool poll(void);
+
+	// Closes the channel for both ends and wakes any waiter. Safe to call
+	// more than once.
+	virtual void disconnect(void);
+
+	// Runs callback after every message sent to this end, and on close.
+	virtual bool setReadyCallback(const std::function<void(void)>& callback);
+
+	// Runs callback once, after the next message sent to this end or on
+	// close, or right away if one is waiting already.
+	virtual bool notifyWhenReady(const std::function<void(void)>& callback);
+
+	// Messages that may be in flight each way before a sender waits.
+	static const Uint Capacity = 64;
+
+private:
+	// Message pointers travelling one way, and their count.
+	struct Direction{
+		Direction(void);
+
+		RingBuffer<Probe::Message*> queue;
+		Semaphore count;
+		// Run by the sender once onReady is set (see setReadyCallback()).
+		std::function<void(void)> callback;
+		std::atomic<bool> onReady;
+		// Run once by whichever of the sender or the reader sees a message
+		// first (see notifyWhenReady()); waiting is set while one is held.
+		std::mutex waiterMutex;
+		std::function<void(void)> waiter;
+		std::atomic<bool> waiting;
+	};
+
+	// State shared by the two ends.
+	struct Link{
+		Link(void);
+
+		Direction ways[2];
+		std::atomic<bool> closed;
+	};
+
+	// Creates the end which sends on ways[side] of link.
+	explicit LocalChannel(const std::shared_ptr<Link>& link, const Uint side);
+
+	// Not copyable.
+	LocalChannel(const LocalChannel&);
+	LocalChannel& operator=(const LocalChannel&);
+
+	// Queues msg without waking the receiver. Returns false if closed.
+	bool push(const Probe::Message& msg);
+
+	// Runs the receiver's callback on way, if it has one, and its one-shot
+	// waiter, if one is held.
+	static void Notify(Direction& way);
+
+	// Takes way's waiter, if it still holds one, and runs it.
+	static void Wake(Direction& way);
+
+	// Returns a message buffer from the pool, or a new one.
+	static Probe::Message* Acquire(void);
+
+	// Returns a message buffer to the pool.
+	static void Release(Probe::Message* msg);
+
+	std::shared_ptr<Link> m_link;
+	// Queue this end sends on; it receives on the other.
+	Uint m_side;
+};
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,185 @@
+// ================================================ //
+// File: MPSCQueue.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines MPSCQueue class, a lock-free multi-producer
+// single-consumer queue.
+// ================================================ //
+
+#ifndef __MPSCQUEUE_HPP__
+#define __MPSCQUEUE_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+#include "Semaphore.hpp"
+
+// ================================================ //
+// An unbounded linked queue (Vyukov's MPSC design). Producers append with a
+// single atomic exchange on the head; the one consumer unlinks from the tail
+// without touching the producers' cache line. A Semaphore counts the items
+// so the consumer can block with a timeout instead of spinning.
+template<typename T>
+class MPSCQueue
+{
+public:
+	// Creates the empty queue.
+	explicit MPSCQueue(void);
+
+	// Frees any items left in the queue.
+	~MPSCQueue(void);
+
+	// Appends an item. Safe from any number of threads.
+	void push(const T& item);
+
+	// Removes the oldest item. Returns false if empty. Consumer only.
+	bool tryPop(T& item);
+
+	// Removes the oldest item, waiting up to ms milliseconds for one to
+	// arrive. Returns false if timed out. Consumer only.
+	bool pop(T& item, const Uint ms);
+
+	// Appends every item currently in the queue to out, oldest first.
+	// Returns number of items removed. Consumer only.
+	const Uint drain(std::vector<T>& out);
+
+	// Returns true if no items are visible to the consumer.
+	const bool empty(void) const;
+
+private:
+	// Not copyable.
+	MPSCQueue(const MPSCQueue&);
+	MPSCQueue& operator=(const MPSCQueue&);
+
+	struct Node{
+		std::atomic<Node*> next;
+		T item;
+	};
+
+	// Unlinks the next item, waiting out a producer which has swapped the
+	// head but not yet linked its node. Only called when m_count says an
+	// item is there.
+	void take(T& item);
+
+	// Most recently pushed node, written by producers.
+	std::atomic<Node*> m_head;
+	char m_pad[CACHE_LINE_SIZE];
+	// Node before the oldest item, owned by the consumer.
+	Node* m_tail;
+	// Number of items pushed but not popped.
+	Semaphore m_count;
+};
+
+// ================================================ //
+
+template<typename T>
+MPSCQueue<T>::MPSCQueue(void) :
+m_head(nullptr),
+m_tail(nullptr),
+m_count(0)
+{
+	// The queue always holds one stub node ahead of the oldest item.
+	Node* stub = new Node();
+	stub->next.store(nullptr, std::memory_order_relaxed);
+	m_head.store(stub, std::memory_order_relaxed);
+	m_tail = stub;
+}
+
+// ================================================ //
+
+template<typename T>
+MPSCQueue<T>::~MPSCQueue(void)
+{
+	while (m_tail != nullptr){
+		Node* next = m_tail->next.load(std::memory_order_relaxed);
+		delete m_tail;
+		m_tail = next;
+	}
+}
+
+// ================================================ //
+
+template<typename T>
+void MPSCQueue<T>::push(const T& item)
+{
+	Node* node = new Node();
+	node->next.store(nullptr, std::memory_order_relaxed);
+	node->item = item;
+
+	Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+	prev->next.store(node, std::memory_order_release);
+
+	m_count.signal();
+}
+
+// ================================================ //
+
+template<typename T>
+bool MPSCQueue<T>::tryPop(T& item)
+{
+	if (m_count.tryWait() == false){
+		return false;
+	}
+
+	this->take(item);
+	return true;
+}
+
+// ================================================ //
+
+template<typename T>
+bool MPSCQueue<T>::pop(T& item, const Uint ms)
+{
+	if (m_count.waitFor(ms) == false){
+		return false;
+	}
+
+	this->take(item);
+	return true;
+}
+
+// ================================================ //
+
+template<typename T>
+const Uint MPSCQueue<T>::drain(std::vector<T>& out)
+{
+	Uint count = 0;
+	T item;
+	while (this->tryPop(item)){
+		out.push_back(item);
+		++count;
+	}
+
+	return count;
+}
+
+// ================================================ //
+
+template<typename T>
+void MPSCQueue<T>::take(T& item)
+{
+	Node* next = m_tail->next.load(std::memory_order_acquire);
+	while (next == nullptr){
+		std::this_thread::yield();
+		next = m_tail->next.load(std::memory_order_acquire);
+	}
+
+	// The node holding the item becomes the new stub.
+	item = next->item;
+	delete m_tail;
+	m_tail = next;
+}
+
+// ================================================ //
+
+template<typename T>
+inline const bool MPSCQueue<T>::empty(void) const{
+	return (m_tail->next.load(std::memory_order_acquire) == nullptr);
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,287 @@
+// ================================================ //
+// File: MultiQueue.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines MultiQueue class, a relaxed concurrent
+// priority queue.
+// ================================================ //
+
+#ifndef __MULTIQUEUE_HPP__
+#define __MULTIQUEUE_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+#include <algorithm>
+
+// ================================================ //
+// A concurrent priority queue made of several small binary heaps, each with
+// its own lock. Inserts go to a random heap; removes look at the tops of two
+// random heaps and pop the better one. The item returned is not always the
+// global minimum, but it is close to it with high probability, and threads
+// almost never contend on the same lock. Key is a functor returning a
+// uint64_t priority for an item, lower values come out first.
+template<typename T, typename Key>
+class MultiQueue
+{
+public:
+	// Allocates the heaps. A shard count of zero picks two per core.
+	explicit MultiQueue(const Uint capacity, const Uint shards = 0);
+
+	// Empty destructor.
+	~MultiQueue(void);
+
+	// Inserts an item. Returns false if the queue is at capacity.
+	bool push(const T& item);
+
+	// Inserts up to count items into one heap under a single lock. Stops
+	// when the queue is full. Returns number of items inserted, which are
+	// always the first ones.
+	const Uint pushMany(const T* items, const Uint count);
+
+	// Removes an item of (near) lowest key. Returns false if empty.
+	bool pop(T& item);
+
+	// Removes every item for which expired(item) holds from the front of each
+	// heap and appends them to out. Returns number of items removed.
+	template<typename Pred>
+	Uint drainWhile(Pred expired, std::vector<T>& out);
+
+	// Returns approximate number of items in queue.
+	const Uint size(void) const;
+
+	// Returns maximum number of items in queue.
+	const Uint capacity(void) const;
+
+private:
+	// Not copyable.
+	MultiQueue(const MultiQueue&);
+	MultiQueue& operator=(const MultiQueue&);
+
+	struct Shard{
+		std::mutex mutex;
+		std::vector<T> heap;
+		// Key of heap top, readable without the lock. EmptyKey if empty.
+		std::atomic<uint64_t> top;
+		char pad[CACHE_LINE_SIZE];
+	};
+
+	// Orders the heaps so the lowest key is on top.
+	struct Greater{
+		bool operator()(const T& a, const T& b) const{
+			return (Key()(a) > Key()(b));
+		}
+	};
+
+	// Pops the top of a locked shard and refreshes its cached key.
+	void popLocked(Shard& shard, T& item);
+
+	// Returns a random shard index for the calling thread.
+	const Uint randomShard(void) const;
+
+	static const uint64_t EmptyKey = ~static_cast<uint64_t>(0);
+
+	std::vector<std::unique_ptr<Shard>> m_shards;
+	Uint m_capacity;
+	std::atomic<Uint> m_size;
+};
+
+// ================================================ //
+
+template<typename T, typename Key>
+MultiQueue<T, Key>::MultiQueue(const Uint capacity, const Uint shards) :
+m_shards(),
+m_capacity(capacity),
+m_size(0)
+{
+	Uint count = shards;
+	if (count == 0){
+		count = std::max<Uint>(2, 2 * std::thread::hardware_concurrency());
+	}
+
+	for (Uint i = 0; i < count; ++i){
+		std::unique_ptr<Shard> shard(new Shard());
+		shard->heap.reserve(capacity / count + 1);
+		shard->top.store(EmptyKey, std::memory_order_relaxed);
+		m_shards.push_back(std::move(shard));
+	}
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+MultiQueue<T, Key>::~MultiQueue(void)
+{
+
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+bool MultiQueue<T, Key>::push(const T& item)
+{
+	// Reserve a slot first so the capacity is never exceeded.
+	if (m_size.fetch_add(1, std::memory_order_relaxed) >= m_capacity){
+		m_size.fetch_sub(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	for (;;){
+		Shard& shard = *m_shards[this->randomShard()];
+		// Skip busy heaps rather than queueing on their lock.
+		if (shard.mutex.try_lock()){
+			shard.heap.push_back(item);
+			std::push_heap(shard.heap.begin(), shard.heap.end(), Greater());
+			shard.top.store(Key()(shard.heap.front()), std::memory_order_release);
+			shard.mutex.unlock();
+			return true;
+		}
+	}
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+const Uint MultiQueue<T, Key>::pushMany(const T* items, const Uint count)
+{
+	// Reserve as many slots as are free, up to count.
+	Uint size = m_size.load(std::memory_order_relaxed);
+	Uint n = 0;
+	do{
+		n = (size < m_capacity) ? std::min(count, m_capacity - size) : 0;
+		if (n == 0){
+			return 0;
+		}
+	} while (m_size.compare_exchange_weak(size, size + n, 
+										  std::memory_order_relaxed) == false);
+
+	for (;;){
+		Shard& shard = *m_shards[this->randomShard()];
+		if (shard.mutex.try_lock()){
+			for (Uint i = 0; i < n; ++i){
+				shard.heap.push_back(items[i]);
+				std::push_heap(shard.heap.begin(), shard.heap.end(), Greater());
+			}
+			shard.top.store(Key()(shard.heap.front()), std::memory_order_release);
+			shard.mutex.unlock();
+			return n;
+		}
+	}
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+bool MultiQueue<T, Key>::pop(T& item)
+{
+	while (m_size.load(std::memory_order_relaxed) > 0){
+		// Two random choices, take the one with the better top.
+		Uint a = this->randomShard();
+		Uint b = this->randomShard();
+		uint64_t keyA = m_shards[a]->top.load(std::memory_order_acquire);
+		uint64_t keyB = m_shards[b]->top.load(std::memory_order_acquire);
+		Uint pick = (keyB < keyA) ? b : a;
+
+		if (keyA == EmptyKey && keyB == EmptyKey){
+			// Both empty, sweep every heap before giving up so a lightly
+			// loaded queue never reports empty while holding items.
+			pick = static_cast<Uint>(m_shards.size());
+			for (Uint i = 0; i < m_shards.size(); ++i){
+				if (m_shards[i]->top.load(std::memory_order_acquire) != EmptyKey){
+					pick = i;
+					break;
+				}
+			}
+			if (pick == m_shards.size()){
+				return false;
+			}
+		}
+
+		Shard& shard = *m_shards[pick];
+		if (shard.mutex.try_lock()){
+			if (shard.heap.empty() == false){
+				this->popLocked(shard, item);
+				shard.mutex.unlock();
+				return true;
+			}
+			shard.mutex.unlock();
+		}
+	}
+
+	return false;
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+template<typename Pred>
+Uint MultiQueue<T, Key>::drainWhile(Pred expired, std::vector<T>& out)
+{
+	Uint count = 0;
+	for (Uint i = 0; i < m_shards.size(); ++i){
+		Shard& shard = *m_shards[i];
+		if (shard.top.load(std::memory_order_acquire) == EmptyKey){
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		while (shard.heap.empty() == false && expired(shard.heap.front())){
+			T item;
+			this->popLocked(shard, item);
+			out.push_back(item);
+			++count;
+		}
+	}
+
+	return count;
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+void MultiQueue<T, Key>::popLocked(Shard& shard, T& item)
+{
+	std::pop_heap(shard.heap.begin(), shard.heap.end(), Greater());
+	item = shard.heap.back();
+	shard.heap.pop_back();
+
+	shard.top.store(shard.heap.empty() ? EmptyKey : Key()(shard.heap.front()),
+					std::memory_order_release);
+	m_size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+const Uint MultiQueue<T, Key>::randomShard(void) const
+{
+	// Per-thread xorshift, seeded from the address of the thread's state.
+	static thread_local uint64_t state = 0;
+	if (state == 0){
+		state = reinterpret_cast<uintptr_t>(&state) | 1;
+	}
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+
+	return static_cast<Uint>(state % m_shards.size());
+}
+
+// ================================================ //
+
+template<typename T, typename Key>
+inline const Uint MultiQueue<T, Key>::size(void) const{
+	return m_size.load(std::memory_order_relaxed);
+}
+
+template<typename T, typename Key>
+inline const Uint MultiQueue<T, Key>::capacity(void) const{
+	return m_capacity;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -8,30 +8,96 @@
 
 #include "Probe.hpp"
 #include "TFC.hpp"
+#include "Channel.hpp"
+#include "ShmChannel.hpp"
+#include "TimerWheel.hpp"
+#include "LatencyHistogram.hpp"
+#include "ScoutSampler.hpp"
+#include "AsteroidField.hpp"
+#include <climits>
 
 // ================================================ //
 
-Probe::Probe(const Uint type) :
+// Storage for BatchMax, which std::min() and std::max() bind by reference.
+const Uint Probe::BatchMax;
+
+// ================================================ //
+
+// Time to destroy an asteroid of mass with a weapon doing power per hit,
+// recharging for recharge ms between hits.
+static constexpr Uint KillTimeOf(const Uint mass, const Uint power,
+								 const Uint recharge)
+{
+	return (power == 0) ? 0 :
+		(mass <= power) ? 0 : ((mass + power - 1) / power - 1) * recharge;
+}
+
+// Time for a probe of type to destroy an asteroid of mass.
+static constexpr Uint KillTimeFor(const Uint type, const Uint mass)
+{
+	return KillTimeOf(mass, Probe::WeaponPower(type), Probe::WeaponRechargeTime(type));
+}
+
+// Kill time (ms) by probe type and mass, one column per mass in Masses.
+template<Uint... Masses>
+struct KillTable{
+	static constexpr Uint Times[Probe::Type::PHASER + 1][sizeof...(Masses)] = {
+		{ KillTimeFor(0, Masses)... },
+		{ KillTimeFor(Probe::Type::SCOUT, Masses)... },
+		{ KillTimeFor(Probe::Type::PHOTON, Masses)... },
+		{ KillTimeFor(Probe::Type::PHASER, Masses)... }
+	};
+};
+
+template<Uint... Masses>
+constexpr Uint KillTable<Masses...>::Times[Probe::Type::PHASER + 1][sizeof...(Masses)];
+
+// Expands to KillTable<0, 1, ..., Count - 1>.
+template<Uint Count, Uint... Masses>
+struct MakeKillTable : MakeKillTable<Count - 1, Count - 1, Masses...>{};
+
+template<Uint... Masses>
+struct MakeKillTable<0, Masses...>{
+	typedef KillTable<Masses...> Type;
+};
+
+typedef MakeKillTable<Probe::KillTableMass + 1>::Type KillTimes;
+
+static_assert(sizeof(KillTimes::Times[0]) / sizeof(Uint) == Probe::KillTableMass + 1 &&
+			  KillTimes::Times[Probe::Type::PHOTON][11] == 6000 &&
+			  KillTimes::Times[Probe::Type::PHASER][9] == 4000 &&
+			  KillTimes::Times[Probe::Type::PHASER][3] == 0,
+			  "Kill time table disagrees with the weapons.");
+
+// ================================================ //
+
+Probe::Probe(const Uint type, const Uint batchSize) :
 m_id(0),
 m_type(type),
 m_state(Probe::State::STANDBY),
-m_socket(INVALID_SOCKET),
+m_channel(),
 m_server(nullptr),
-m_weaponRechargeTime(0),
-m_weaponPower(0),
-m_generator()
+m_weaponRechargeTime(Probe::WeaponRechargeTime(type)),
+m_weaponPower(Probe::WeaponPower(type)),
+m_batchSize(std::min<Uint>(std::max<Uint>(batchSize, 1), Probe::BatchMax)),
+m_asteroidCount(0),
+m_discoveryHeld(false),
+m_heldDiscoveryTime(0),
+m_actions(),
+m_wheel(nullptr),
+m_current(),
+m_sampler(),
+m_samples(),
+m_sampleNext(),
+m_field(nullptr),
+m_fieldNext(0),
+m_fieldTime(0),
+m_fieldRealTime(true)
 {
 	// Allocate timer for scout probe.
 	if (m_type == Probe::Type::SCOUT){		
-		m_generator.seed(GetTickCount());
-	}
-	else if (m_type == Probe::Type::PHOTON){
-		m_weaponRechargeTime = 3000;
-		m_weaponPower = 5;
-	}
-	else if(m_type == Probe::Type::PHASER){
-		m_weaponRechargeTime = 2000;
-		m_weaponPower = 3;
+		this->seed(static_cast<Uint>(
+			std::chrono::steady_clock::now().time_since_epoch().count()));
 	}
 }
 
@@ -39,12 +105,12 @@ m_generator()
 
 Probe::~Probe(void)
 {
-	closesocket(m_socket);
+
 }
 
 // ================================================ //
 
-bool Probe::launch(void)
+bool Probe::connectSocket(void)
 {
 	// Get server address.
 	struct addrinfo hints;
@@ -61,58 +127,98 @@ bool Probe::launch(void)
 	}
 
 	// Create socket.
-	m_socket = socket(m_server->ai_family, m_server->ai_socktype, m_server->ai_protocol);
-	if (m_socket == INVALID_SOCKET){
-		printf("PROBE: socket() failed: %ld\n", WSAGetLastError());
+	SOCKET sock = socket(m_server->ai_family, m_server->ai_socktype, m_server->ai_protocol);
+	if (sock == INVALID_SOCKET){
+		printf("PROBE: socket() failed: %ld\n", static_cast<long>(WSAGetLastError()));
 		return false;
 	}
 
 	// Connect to TFC.
-	i = connect(m_socket, m_server->ai_addr, static_cast<int>(m_server->ai_addrlen));
+	i = connect(sock, m_server->ai_addr, static_cast<int>(m_server->ai_addrlen));
 	if (i == SOCKET_ERROR){
-		printf("PROBE: connect() failed: %ld\n", WSAGetLastError());
-		closesocket(m_socket);
-		m_socket = INVALID_SOCKET;
+		printf("PROBE: Unable to connect to server: %ld\n", static_cast<long>(WSAGetLastError()));
+		closesocket(sock);
+		return false;
 	}
 
-	if (m_socket == INVALID_SOCKET){
-		printf("PROBE: Unable to connect to server: %ld\n", WSAGetLastError());
+	m_channel.reset(new SocketChannel(sock));
+	return true;
+}
+
+// ================================================ //
+
+bool Probe::launch(TimerWheel* wheel, const Uint transport)
+{
+	// A TFC in this process takes the launch request without a socket.
+	if (transport == Transport::IN_PROCESS){
+		m_channel.reset(TFC::ConnectLocal());
+	}
+	if (m_channel == nullptr && this->connectSocket() == false){
 		return false;
 	}
 
+	// Set up the rings before asking the TFC to attach to them.
+	std::unique_ptr<ShmChannel> shm;
+	if (transport == Transport::SHARED_MEMORY){
+		shm.reset(new ShmChannel());
+		if (shm->create() == false){
+			shm.reset();
+		}
+	}
+
 	// Send launch request.
 	Message msg;
+	ZeroMemory(&msg, sizeof(msg));
 	msg.type = MessageType::LAUNCH_REQUEST;
 	msg.LaunchRequest.type = m_type;
+	if (shm){
+		msg.LaunchRequest.transport = Transport::SHARED_MEMORY;
+		strncpy(msg.LaunchRequest.segment, shm->getName().c_str(), 
+				Probe::SegmentNameMax - 1);
+	}
 	
-	i = send(m_socket, reinterpret_cast<const char*>(&msg), sizeof(msg), 0);
-	if (i == SOCKET_ERROR){
-		printf("PROBE: send() failed: %ld\n", WSAGetLastError());
-		closesocket(m_socket);
+	if (m_channel->send(msg) == false){
+		printf("PROBE: send() failed: %ld\n", static_cast<long>(WSAGetLastError()));
+		m_channel->disconnect();
 		return false;
 	}
 
 	// Wait for confirmation of launch.
 	ZeroMemory(&msg, sizeof(msg));
-	i = recv(m_socket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-	if (i == SOCKET_ERROR){
-		printf("PROBE: recv() failed: %ld\n", WSAGetLastError());
-		closesocket(m_socket);
+	if (m_channel->receive(msg) == false){
+		// Connection closed by server, or failed.
+		printf("PROBE: recv() failed: %ld\n", static_cast<long>(WSAGetLastError()));
+		m_channel->disconnect();
 		return false;
 	}
-	if (i > 0){
-		if (msg.type == MessageType::CONFIRM_LAUNCH){
-			// Launch confirmed, save ID assigned by TFC.
-			m_id = msg.id;			
-			std::thread t(&Probe::update, this);
-			t.detach();
+
+	if (msg.type == MessageType::CONFIRM_LAUNCH){
+		if (shm){
+			// The TFC has attached or declined; either way the name is
+			// done with.
+			shm->unlink();
+			if (msg.LaunchRequest.transport == Transport::SHARED_MEMORY){
+				// Closes the socket.
+				m_channel.reset(shm.release());
+			}
+		}
+
+		this->onReply(msg);
+		if (wheel != nullptr){
+			m_wheel = wheel;
+#if defined(__cpp_impl_coroutine)
+			this->behave();
+#else
+			m_current = this->nextAction();
+			m_wheel->schedule(m_current.delay, [this](){ this->step(); });
+#endif
 		}
 		else{
-			return false;
+			std::thread t(&Probe::update, this);
+			t.detach();
 		}
 	}
 	else{
-		// Connection closed by server.
 		return false;
 	}
 
@@ -124,152 +230,438 @@ bool Probe::launch(void)
 void Probe::update(void)
 {
 	while (m_state != Probe::State::DESTROYED){
-		switch (m_type){
-		default:
+		Probe::Action action = this->nextAction();
+		if (action.send && action.msg.type == Probe::MessageType::TARGET_DESTROYED){
+			printf("Probe %d acquired data for asteroid %llu\n\n", m_id,
+				   static_cast<unsigned long long>(action.msg.asteroid.id));
+		}
+
+		Timer::Delay(action.delay);
+
+		int64_t sent = Telemetry::Now();
+		if (action.send && m_channel->send(action.msg) == false){
+			// Lost connection to TFC.
+			m_state = Probe::State::DESTROYED;
 			break;
+		}
 
-		case Probe::Type::SCOUT:
-			{									
-				Probe::Message msg;
-				// Send request with data.
-				if (m_state == Probe::State::STANDBY){
-					int r = recv(m_socket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-					if (r > 0){
-						if (msg.type == Probe::MessageType::SCOUT_REQUEST){
-							// TFC has entered asteroid field, begin scouting.
-							m_state = Probe::State::ACTIVE;
-						}
-					}
-				}
-				else if(m_state == Probe::State::ACTIVE){
-					// Wait random length of time to discover asteroid according to Poisson
-					// distribution.															
-					Timer::Delay(this->scoutDiscoveryTime());
-
-					// Tell TFC scout is about to report new asteroid.
-					msg.type = Probe::MessageType::SCOUT_REQUEST;
-					int s = send(m_socket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-					if (s > 0){
-						ZeroMemory(&msg, sizeof(msg));
-						int r = recv(m_socket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-						if (r > 0){
-							// Only proceed with corresponding TFC response.
-							if (msg.type != Probe::MessageType::SCOUT_REQUEST){
-								break;
-							}
-						}
-						else{
-							break;
-						}
-					}
-
-					// Allocate data for newly discovered asteroid.
-					static Uint asteroidIDCtr = 0;
-					Asteroid asteroid;
-					asteroid.id = asteroidIDCtr++;
-					asteroid.discoveryTime = msg.time;
-
-					// Determine asteroid mass based on step function.
-					asteroid.mass = this->scoutAsteroidSize();
-
-					// Determine time to impact based on uniform distribution.
-					asteroid.impactTime = asteroid.discoveryTime + this->scoutTimeToImpact();
-
-					// Send the asteroid data to TFC.
-					ZeroMemory(&msg, sizeof(msg));
-					msg.type = Probe::MessageType::ASTEROID_FOUND;
-					msg.asteroid = asteroid;
-					s = send(m_socket, reinterpret_cast<const char*>(&msg), sizeof(msg), 0);
-				}
+		if (action.awaitReply){
+			const Probe::Message* reply = m_channel->take();
+			if (reply == nullptr){
+				// Lost connection to TFC.
+				m_state = Probe::State::DESTROYED;
+				break;
+			}
+			if (action.send){
+				Telemetry::Record(m_type, action.msg.type, Telemetry::ROUND_TRIP,
+								  Telemetry::Now() - sent);
+			}
+			this->onReply(*reply);
+			m_channel->release(reply);
+		}
+	}
+
+	m_channel->disconnect();
+}
+
+// ================================================ //
+
+void Probe::step(void)
+{
+	if (m_current.send){
+		if (m_current.msg.type == Probe::MessageType::TARGET_DESTROYED){
+			printf("Probe %d acquired data for asteroid %llu\n\n", m_id,
+				   static_cast<unsigned long long>(m_current.msg.asteroid.id));
+		}
+		if (m_channel->send(m_current.msg) == false){
+			m_state = Probe::State::DESTROYED;
+		}
+		m_current.send = false;
+	}
+
+	if (m_state != Probe::State::DESTROYED && m_current.awaitReply){
+		if (m_channel->poll() == false){
+			// Reply not in yet; rather than hold a worker, carry on when the
+			// channel says it has arrived, or if it can't, look again
+			// shortly. Either way this step is over.
+			if (m_channel->notifyWhenReady([this](){ this->step(); }) == false){
+				m_wheel->schedule(Probe::PollInterval, [this](){ this->step(); });
+			}
+			return;
+		}
+
+		const Probe::Message* reply = m_channel->take();
+		if (reply != nullptr){
+			this->onReply(*reply);
+			m_channel->release(reply);
+		}
+		else{
+			// Lost connection to TFC.
+			m_state = Probe::State::DESTROYED;
+		}
+	}
+
+	if (m_state == Probe::State::DESTROYED){
+		m_channel->disconnect();
+		return;
+	}
+
+	m_current = this->nextAction();
+	m_wheel->schedule(m_current.delay, [this](){ this->step(); });
+}
+
+// ================================================ //
+
+#if defined(__cpp_impl_coroutine)
+
+Coroutine Probe::behave(void)
+{
+	while (m_state != Probe::State::DESTROYED){
+		Probe::Action action = this->nextAction();
+		co_await TimerAwaiter(m_wheel, action.delay);
+
+		if (action.send){
+			if (action.msg.type == Probe::MessageType::TARGET_DESTROYED){
+				printf("Probe %d acquired data for asteroid %llu\n\n", m_id,
+					   static_cast<unsigned long long>(action.msg.asteroid.id));
+			}
+			if (m_channel->send(action.msg) == false){
+				// Lost connection to TFC.
+				m_state = Probe::State::DESTROYED;
+				break;
+			}
+		}
+
+		if (action.awaitReply){
+			co_await ChannelAwaiter(m_wheel, m_channel.get(), Probe::PollInterval);
+
+			const Probe::Message* reply = m_channel->take();
+			if (reply == nullptr){
+				// Lost connection to TFC.
+				m_state = Probe::State::DESTROYED;
+				break;
+			}
+			this->onReply(*reply);
+			m_channel->release(reply);
+		}
+	}
+
+	m_channel->disconnect();
+}
+
+#endif
+
+// ================================================ //
+
+void Probe::seed(const Uint seed)
+{
+	m_sampler.reset(new ScoutSampler(seed));
+	for (Uint i = 0; i < ScoutSampler::NUM_STREAMS; ++i){
+		m_samples[i].clear();
+		m_sampleNext[i] = 0;
+	}
+}
+
+// ================================================ //
+
+void Probe::stream(const AsteroidField* field, const bool realTime)
+{
+	m_field = field;
+	m_fieldNext = 0;
+	m_fieldTime = 0;
+	m_fieldRealTime = realTime;
+}
+
+// ================================================ //
+
+const Probe::Action Probe::nextAction(void)
+{
+	if (m_actions.empty()){
+		this->plan();
+	}
+
+	Probe::Action action = m_actions.front();
+	m_actions.pop_front();
+	if (action.send && action.msg.type == Probe::MessageType::TERMINATED){
+		m_state = Probe::State::DESTROYED;
+	}
+
+	return action;
+}
+
+// ================================================ //
+
+void Probe::onReply(const Message& reply)
+{
+	switch (reply.type){
+	default:
+		break;
+
+	case Probe::MessageType::CONFIRM_LAUNCH:
+		// Launch confirmed, save ID assigned by TFC.
+		m_id = reply.id;
+		break;
+
+	case Probe::MessageType::SCOUT_REQUEST:
+		if (m_type == Probe::Type::SCOUT){
+			if (m_state == Probe::State::STANDBY){
+				// TFC has entered asteroid field, begin scouting.
+				m_state = Probe::State::ACTIVE;
+			}
+			else{
+				// TFC acknowledged the discovery with the current time.
+				this->planReport(reply.time);
 			}
+		}
+		break;
+
+	case Probe::MessageType::TARGETS_AVAILABLE:
+		this->planAttack(reply);
+		break;
+
+	case Probe::MessageType::NO_TARGET:
+		{
+			Probe::Action wait;
+			ZeroMemory(&wait, sizeof(wait));
+			wait.delay = 500;
+			m_actions.push_back(wait);
+		}
+		break;
+	}
+}
+
+// ================================================ //
+
+void Probe::plan(void)
+{
+	Probe::Action action;
+	ZeroMemory(&action, sizeof(action));
+
+	switch (m_type){
+	default:
+		break;
+
+	case Probe::Type::SCOUT:
+		if (m_state == Probe::State::STANDBY){
+			// Wait for the TFC to enter the asteroid field.
+			action.awaitReply = true;
+		}
+		else if (m_field != nullptr){
+			// Wait for the next recorded discovery, if there is one, then
+			// tell the TFC as usual.
+			if (m_fieldNext >= m_field->getCount()){
+				action.delay = Probe::StreamIdleInterval;
+			}
+			else if (m_fieldRealTime){
+				Uint discoveryTime = m_field->getAsteroid(m_fieldNext).discoveryTime;
+				action.delay = (discoveryTime > m_fieldTime) ?
+					discoveryTime - m_fieldTime : 0;
+			}
+			action.send = true;
+			action.awaitReply = true;
+			action.msg.type = Probe::MessageType::SCOUT_REQUEST;
+		}
+		else{
+			// Wait random length of time to discover asteroid according to
+			// Poisson distribution, then tell TFC scout is about to report
+			// new asteroid.
+			if (m_discoveryHeld){
+				action.delay = m_heldDiscoveryTime;
+				m_discoveryHeld = false;
+			}
+			else{
+				action.delay = this->scoutDiscoveryTime();
+			}
+			action.send = true;
+			action.awaitReply = true;
+			action.msg.type = Probe::MessageType::SCOUT_REQUEST;
+		}
+		break;
+
+	case Probe::Type::PHASER:
+	case Probe::Type::PHOTON:
+		// Send defensive request.
+		action.send = true;
+		action.awaitReply = true;
+		action.msg.type = Probe::MessageType::DEFENSIVE_BATCH_REQUEST;
+		action.msg.Batch.count = m_batchSize;
+		break;
+	}
+
+	m_actions.push_back(action);
+}
+
+// ================================================ //
+
+void Probe::planReport(const Uint time)
+{
+	if (m_field != nullptr){
+		this->planStreamReport(time);
+		return;
+	}
+
+	// Report a batch of asteroids in one message. Only the first discovery
+	// asks the TFC for the time; the rest are timed from it using the
+	// delays waited before sending. A discovery outside ReportWindow, or
+	// which would hold the batch within ReportLeadTime of an impact, is
+	// left for the next cycle and the batch sent as it is.
+	Probe::Action action;
+	ZeroMemory(&action, sizeof(action));
+	action.send = true;
+	action.msg.type = Probe::MessageType::ASTEROIDS_FOUND;
+
+	Uint discoveryTime = time;
+	Uint soonestImpact = UINT_MAX;
+	for (Uint i = 0; i < m_batchSize; ++i){
+		if (i > 0){
+			Uint delay = this->scoutDiscoveryTime();
+			if (discoveryTime + delay > time + Probe::ReportWindow ||
+				discoveryTime + delay + Probe::ReportLeadTime > soonestImpact){
+				m_heldDiscoveryTime = delay;
+				m_discoveryHeld = true;
+				break;
+			}
+			action.delay += delay;
+			discoveryTime += delay;
+		}
+
+		// Allocate data for newly discovered asteroid. IDs are unique per
+		// scout, and match the plain count for the first one launched.
+		Asteroid& asteroid = action.msg.Batch.asteroids[action.msg.Batch.count++];
+		asteroid.id = (static_cast<uint64_t>(m_id) << 32) | m_asteroidCount++;
+		asteroid.discoveryTime = discoveryTime;
+
+		// Determine asteroid mass based on step function.
+		asteroid.mass = this->scoutAsteroidSize();
+
+		// Determine time to impact based on uniform distribution.
+		asteroid.impactTime = asteroid.discoveryTime + this->scoutTimeToImpact();
+		soonestImpact = std::min(soonestImpact, asteroid.impactTime);
+	}
+
+	m_actions.push_back(action);
+}
+
+// ================================================ //
+
+void Probe::planStreamReport(const Uint time)
+{
+	Uint count = m_field->getCount();
+	if (m_fieldNext >= count){
+		// Nothing left; the request was only a check-in.
+		return;
+	}
+
+	// Report the next batch as recorded, shifted so the first is
+	// discovered at TFC time. In real time the rest are waited for before
+	// sending, within the same limits as when rolling them.
+	Probe::Action action;
+	ZeroMemory(&action, sizeof(action));
+	action.send = true;
+	action.msg.type = Probe::MessageType::ASTEROIDS_FOUND;
+
+	Uint first = m_field->getAsteroid(m_fieldNext).discoveryTime;
+	Uint end = std::min(count, m_fieldNext + m_batchSize);
+	Uint soonestImpact = UINT_MAX;
+	for (; m_fieldNext < end; ++m_fieldNext){
+		const Asteroid& recorded = m_field->getAsteroid(m_fieldNext);
+		Uint offset = (recorded.discoveryTime > first) ?
+			recorded.discoveryTime - first : 0;
+		if (m_fieldRealTime && action.msg.Batch.count > 0 &&
+			(offset > Probe::ReportWindow ||
+			 time + offset + Probe::ReportLeadTime > soonestImpact)){
 			break;
+		}
+
+		Asteroid& asteroid = action.msg.Batch.asteroids[action.msg.Batch.count++];
+		asteroid.id = (static_cast<uint64_t>(m_id) << 32) | m_asteroidCount++;
+		asteroid.mass = recorded.mass;
+		asteroid.discoveryTime = time + offset;
+		asteroid.impactTime = asteroid.discoveryTime +
+			(recorded.impactTime - recorded.discoveryTime);
+		if (m_fieldRealTime){
+			action.delay = offset;
+		}
+		m_fieldTime = std::max(m_fieldTime, recorded.discoveryTime);
+		soonestImpact = std::min(soonestImpact, asteroid.impactTime);
+	}
 
-		case Probe::Type::PHASER:
-		case Probe::Type::PHOTON:
-			// Connect to TFC and send defensive request.
-			Probe::Message msg;
-			msg.id = m_id;
-			msg.type = Probe::MessageType::DEFENSIVE_REQUEST;
-			int s = send(m_socket, reinterpret_cast<const char*>(&msg), sizeof(msg), 0);
-			if (s > 0){
-				// Receive response from TFC.
-				ZeroMemory(&msg, sizeof(msg));
-				int r = recv(m_socket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-				if (r > 0){
-					switch (msg.type){
-					default:
-						break;
-
-					case Probe::MessageType::TARGET_AVAILABLE:
-						{
-							Uint timeRequired = this->timeRequired(msg.asteroid);
-
-							// See if we have time to destroy the asteroid.
-							if (msg.time + timeRequired < msg.asteroid.impactTime){
-								printf("Probe %d acquired data for asteroid %d\n\n",
-									   m_id, msg.asteroid.id);
-								// Destroy the asteroid.
-								Timer::Delay(timeRequired);
-
-								// Asteroid destroyed, report to TFC.
-								Probe::Message response;
-								ZeroMemory(&response, sizeof(response));
-								response.type = Probe::MessageType::TARGET_DESTROYED;
-								response.id = msg.asteroid.id;
-								s = send(m_socket, 
-										 reinterpret_cast<const char*>(&response),
-										 sizeof(response),
-										 0);
-
-								// Allow weapon to recharge.
-								Timer::Delay(m_weaponRechargeTime);
-							}
-							else{
-								// Delay any remaining time until impact.
-								Timer::Delay((msg.time + timeRequired) - msg.asteroid.impactTime);
-								// Then report probe termination and ram the asteroid.
-								Probe::Message response;
-								ZeroMemory(&response, sizeof(response));
-								response.type = Probe::MessageType::TERMINATED;
-								response.id = msg.asteroid.id;
-								s = send(m_socket, 
-										 reinterpret_cast<const char*>(&response),
-										 sizeof(response),
-										 0);
-								m_state = Probe::State::DESTROYED;
-								break;
-							}
-						}
-						break;
-
-					case Probe::MessageType::NO_TARGET:
-						Timer::Delay(500);
-						break;
-					}
+	m_actions.push_back(action);
+}
+
+// ================================================ //
+
+void Probe::planAttack(const Message& targets)
+{
+	// Work through the targets in order, keeping track of the TFC time as
+	// weapons fire and recharge.
+	Uint time = targets.time;
+	Uint count = std::min<Uint>(targets.Batch.count, Probe::BatchMax);
+	for (Uint i = 0; i < count; ++i){
+		const Asteroid& a = targets.Batch.asteroids[i];
+		Uint timeRequired = this->timeRequired(a);
+
+		Probe::Action action;
+		ZeroMemory(&action, sizeof(action));
+		action.send = true;
+
+		// See if we have time to destroy the asteroid.
+		if (time + timeRequired < a.impactTime){
+			// Destroy the asteroid, then report to TFC.
+			action.delay = timeRequired;
+			action.msg.type = Probe::MessageType::TARGET_DESTROYED;
+			action.msg.asteroid.id = a.id;
+			m_actions.push_back(action);
+
+			// Allow weapon to recharge.
+			ZeroMemory(&action, sizeof(action));
+			action.delay = m_weaponRechargeTime;
+			m_actions.push_back(action);
+			time += timeRequired + m_weaponRechargeTime;
+		}
+		else{
+			// Hand back the targets this probe won't get to.
+			if (i + 1 < count){
+				action.msg.type = Probe::MessageType::ASTEROIDS_FOUND;
+				for (Uint j = i + 1; j < count; ++j){
+					action.msg.Batch.asteroids[action.msg.Batch.count++] = 
+						targets.Batch.asteroids[j];
 				}
+				m_actions.push_back(action);
+				ZeroMemory(&action, sizeof(action));
+				action.send = true;
 			}
+
+			// Delay any remaining time until impact, then report probe
+			// termination and ram the asteroid.
+			action.delay = (time + timeRequired) - a.impactTime;
+			action.msg.type = Probe::MessageType::TERMINATED;
+			action.msg.asteroid.id = a.id;
+			m_actions.push_back(action);
 			break;
 		}
 	}
-
-	closesocket(m_socket);
 }
 
 // ================================================ //
 
 const Uint Probe::timeRequired(const Asteroid& a)
 {
-	int units = a.mass;
-	Uint time = 0;
-	// Initial hit.
-	units -= m_weaponPower;
-	// Process additional hits if needed.
-	while (units > 0){
-		time += m_weaponRechargeTime;
-		units -= m_weaponPower;				
+	return Probe::KillTime(m_type, a.mass);
+}
+
+// ================================================ //
+
+const Uint Probe::KillTime(const Uint type, const Uint mass)
+{
+	if (type > Probe::Type::PHASER){
+		return 0;
+	}
+	if (mass <= Probe::KillTableMass){
+		return KillTimes::Times[type][mass];
 	}
 
-	return time;
+	return KillTimeFor(type, mass);
 }
 
 // ================================================ //
@@ -280,97 +672,58 @@ const Uint Probe::scoutDiscoveryTime(void)
 	/*std::poisson_distribution<int> poissonDistribution(4.0);
 	return (poissonDistribution(m_generator) * 1000);*/
 
-	std::uniform_real_distribution<double> distribution(0.0, 1.0);
-
-	double x = distribution(m_generator);
-	double deviate = 0.0;
-	if (x == 0.0)     //Interpolate between points on
-		deviate = 0.0;  //graph.
-	else if (x <= 0.1)
-		deviate = ((x - 0.0) * 1.04 + 0.0);
-	else if (x <= 0.2)
-		deviate = ((x - 0.1) * 1.18 + 0.104);
-	else if (x <= 0.3)
-		deviate = ((x - 0.2) * 1.33 + 0.222);
-	else if (x <= 0.4)
-		deviate = ((x - 0.3) * 1.54 + 0.355);
-	else if (x <= 0.5)
-		deviate = ((x - 0.4) * 1.81 + 0.509);
-	else if (x <= 0.6)
-		deviate = ((x - 0.5) * 2.25 + 0.690);
-	else if (x <= 0.7)
-		deviate = ((x - 0.6) * 2.85 + 0.915);
-	else if (x <= 0.75)
-		deviate = ((x - 0.70) * 3.60 + 1.2);
-	else if (x <= 0.8)
-		deviate = ((x - 0.75) * 4.40 + 1.38);
-	else if (x <= 0.84)
-		deviate = ((x - 0.8) * 5.75 + 1.60);
-	else if (x <= 0.88)
-		deviate = ((x - 0.84) * 7.25 + 1.83);
-	else if (x <= 0.9)
-		deviate = ((x - 0.88) * 9.00 + 2.12);
-	else if (x <= 0.92)
-		deviate = ((x - 0.90) * 11.0 + 2.30);
-	else if (x <= 0.94)
-		deviate = ((x - 0.92) * 14.5 + 2.52);
-	else if (x <= 0.95)
-		deviate = ((x - 0.94) * 18.0 + 2.81);
-	else if (x <= 0.96)
-		deviate = ((x - 0.95) * 21.0 + 2.99);
-	else if (x <= 0.97)
-		deviate = ((x - 0.96) * 30.0 + 3.20);
-	else if (x <= 0.98)
-		deviate = ((x - 0.97) * 40.0 + 3.50);
-	else if (x <= 0.99)
-		deviate = ((x - 0.98) * 70.0 + 3.90);
-	else if (x <= 0.995)
-		deviate = ((x - 0.99) * 140.0 + 4.60);
-	else if (x <= 0.998)
-		deviate = ((x - 0.995) * 300.0 + 5.30);
-	else if (x <= 0.999)
-		deviate = ((x - 0.998) * 800.0 + 6.20);
-	else
-		deviate = ((x - 0.9997) * 1000.0 + 8.0);
-
-	// Calculate with mean of 4.0.
-	deviate *= 4.0;
-
-	// Round up?
-	//deviate = std::round(deviate);
-
-	// Convert to milliseconds.
-	deviate *= 1000.0;
-	return static_cast<Uint>(deviate);
+	// Interpolate between points on graph, using the table precomputed
+	// for bulk generation.
+	return this->nextSample(ScoutSampler::Stream::DISCOVERY);
 }
 
 // ================================================ //
 
 const Uint Probe::scoutAsteroidSize(void)
 {
-	std::uniform_real_distribution<double> massDistribution(0.0, 1.0);
-	double step = massDistribution(m_generator);
-	if (step < 0.2){
-		return 3;
-	}
-	else if (step < 0.5){
-		return 6;
-	}
-	else if (step < 0.7){
-		return 9;
-	}
-	else{
-		return 11;
-	}
+	// Step function: 3, 6, 9 or 11 with probability 0.2, 0.3, 0.2, 0.3.
+	return this->nextSample(ScoutSampler::Stream::MASS);
 }
 
 // ================================================ //
 
 const Uint Probe::scoutTimeToImpact(void)
 {
-	std::uniform_real_distribution<double> impactDistribution(0.0, 15.0);
-	double time = impactDistribution(m_generator) * 1000.0;
-	return static_cast<Uint>(time);
+	// Uniform over [0, 15) seconds.
+	return this->nextSample(ScoutSampler::Stream::IMPACT);
+}
+
+// ================================================ //
+
+const Uint Probe::nextSample(const Uint stream)
+{
+	// Probes other than the scout only get a sampler if asked.
+	if (m_sampler == nullptr){
+		this->seed(static_cast<Uint>(
+			std::chrono::steady_clock::now().time_since_epoch().count()));
+	}
+
+	std::vector<Uint>& samples = m_samples[stream];
+	if (m_sampleNext[stream] == samples.size()){
+		samples.resize(Probe::SampleBlock);
+		switch (stream){
+		default:
+		case ScoutSampler::Stream::DISCOVERY:
+			m_sampler->discoveryTimes(&samples[0], Probe::SampleBlock);
+			break;
+
+		case ScoutSampler::Stream::MASS:
+			m_sampler->asteroidSizes(&samples[0], Probe::SampleBlock);
+			break;
+
+		case ScoutSampler::Stream::IMPACT:
+			m_sampler->timesToImpact(&samples[0], Probe::SampleBlock);
+			break;
+		}
+		m_sampleNext[stream] = 0;
+	}
+
+	return samples[m_sampleNext[stream]++];
 }
 
 // ================================================ //
\ No newline at end of file
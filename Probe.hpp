@@ -13,30 +13,67 @@
 
 #include "stdafx.hpp"
 #include "Asteroid.hpp"
+#include "Coroutine.hpp"
+#include "ScoutSampler.hpp"
 
 class Timer;
+class Channel;
+class TimerWheel;
+class AsteroidField;
 
 // ================================================ //
 
 class Probe
 {
 public:
-	// Default initializes all member variables.
-	explicit Probe(const Uint type);
+	// Default initializes all member variables. Scouts report, and defenders
+	// request, up to batchSize asteroids per message (at most BatchMax).
+	explicit Probe(const Uint type, const Uint batchSize = 1);
 
-	// Closes the socket.
+	// Closes the connection to the TFC.
 	~Probe(void);
 
-	// Setup probe data and connect to TFC.
-	bool launch(void);
+	// Setup probe data and connect to TFC. The probe then runs on its own
+	// thread, or if wheel is not null, as timers on the wheel so it holds
+	// no thread while waiting. The wheel must outlive the probe.
+	// Asks for the given transport (see Probe::Transport), falling back
+	// to the socket if the TFC or platform can't provide it.
+	bool launch(TimerWheel* wheel = nullptr, 
+				const Uint transport = Transport::SOCKET_STREAM);
 
-	// Thread which processes probe actions.
+	// Thread which processes probe actions over the TFC connection, in real
+	// time.
 	void update(void);
 
+	// Seeds the random number generator used by the scout, dropping any
+	// samples drawn from the last seed.
+	void seed(const Uint seed);
+
+	// Makes a scout report the asteroids in field, in order, instead of
+	// rolling them. If realTime is true each is reported at its recorded
+	// discovery time after the field is entered; otherwise every batch is
+	// sent as soon as the last is acknowledged, to load the TFC. Recorded
+	// times are kept relative to the TFC's clock. The field must outlive
+	// the probe.
+	void stream(const AsteroidField* field, const bool realTime = true);
+
 	// Returns time required in milliseconds to destroy Asteroid a.
 	const Uint timeRequired(const Asteroid& a);
 
-	/// Asteroid discovery randomization functions.
+	// Returns ms a probe of the given type needs to destroy an asteroid of
+	// the given mass: the first hit is immediate, and each further hit
+	// waits for the weapon to recharge. Constant time; masses up to
+	// KillTableMass are looked up in a table built at compile time. Lets
+	// the TFC pick targets a defender can actually reach.
+	static const Uint KillTime(const Uint type, const Uint mass);
+
+	// Weapon recharge time (ms) and damage per hit of a probe type; zero
+	// for the scout.
+	static constexpr Uint WeaponRechargeTime(const Uint type);
+	static constexpr Uint WeaponPower(const Uint type);
+
+	/// Asteroid discovery randomization functions. Each hands out the next
+	// of a block generated in bulk by the probe's ScoutSampler.
 	// Returns amount of time to discovery of next asteroid (ms).
 	const Uint scoutDiscoveryTime(void);
 
@@ -74,10 +111,38 @@ public:
 		ASTEROID_FOUND,
 		TARGET_AVAILABLE,
 		NO_TARGET,
+		// TARGET_DESTROYED and TERMINATED name the asteroid destroyed or
+		// rammed in asteroid.id.
 		TARGET_DESTROYED,
-		TERMINATED
+		TERMINATED,
+		// Batch.count asteroids found by the scout, or targets handed back
+		// by a defender which could not get to them.
+		ASTEROIDS_FOUND,
+		// Request for up to Batch.count targets.
+		DEFENSIVE_BATCH_REQUEST,
+		// Batch.count targets, soonest impact first.
+		TARGETS_AVAILABLE
 	};
 
+	// How a probe exchanges messages with the TFC once launched.
+	enum Transport{
+		// Framed messages over the TCP connection.
+		SOCKET_STREAM = 0,
+		// Rings in a shared memory segment (see ShmChannel), for probes on
+		// the same host as the TFC. The TCP connection is only used to
+		// launch.
+		SHARED_MEMORY,
+		// Pooled messages passed by pointer to a TFC in the same process
+		// (see LocalChannel). No socket is opened at all.
+		IN_PROCESS
+	};
+
+	// Maximum number of asteroids carried by one message.
+	static const Uint BatchMax = 8;
+
+	// Maximum length of a shared memory segment name, including the null.
+	static const Uint SegmentNameMax = 32;
+
 	// A network message.
 	struct Message{
 		// Type of message.
@@ -86,27 +151,137 @@ public:
 		Uint time;
 		// Use a union to minimize data sent over sockets.
 		union{
-			// Request for launch.
+			// Request for launch. CONFIRM_LAUNCH carries the probe's ID in
+			// the first field and the transport granted in the second.
 			struct{
 				// Type of probe.
 				Uint type;
+				// Transport asked for (see Probe::Transport).
+				Uint transport;
+				// Name of the shared memory segment, for SHARED_MEMORY.
+				char segment[SegmentNameMax];
 			} LaunchRequest;
 			// Probe ID.
 			Uint id;
 			// Asteroid data.
 			Asteroid asteroid;
+			// Several asteroids at once. Only the first count are sent.
+			struct{
+				Uint count;
+				Asteroid asteroids[BatchMax];
+			} Batch;
 		};
 	};
 
+	// One step of probe behavior: wait delay ms, then optionally send msg to
+	// the TFC. The behavior itself never sleeps or touches the network, so
+	// it can be driven in real time by update() or in virtual time by a
+	// Simulation.
+	struct Action{
+		// Time to wait before acting (ms).
+		Uint delay;
+		// True if msg is to be sent to the TFC.
+		bool send;
+		// True if the probe needs the TFC's reply before its next action.
+		bool awaitReply;
+		Message msg;
+	};
+
+	// Returns the next action. Sending TERMINATED marks the probe destroyed.
+	const Action nextAction(void);
+
+	// Passes a message from the TFC to the probe, usually the reply to an
+	// action which awaited one.
+	void onReply(const Message& reply);
+
+	// Simulated ms between checks for a TFC reply when run on a TimerWheel,
+	// over a channel which can't say when one arrives.
+	static const Uint PollInterval = 10;
+
+	// Largest mass in the kill time table; covers every mass the scout
+	// reports.
+	static const Uint KillTableMass = 15;
+
+	// A scout only holds a discovery back for the next one if that comes
+	// within ReportWindow ms of the batch's first, and still leaves every
+	// asteroid in the batch ReportLeadTime ms before impact once sent;
+	// otherwise the batch goes as it is. Holding any longer costs more
+	// collisions than the saved messages are worth.
+	static const Uint ReportWindow = 500;
+	static const Uint ReportLeadTime = 8000;
+
+	// Ms between a streaming scout's check-ins with the TFC once its field
+	// has run out, so the TFC still settles the fleet's fate.
+	static const Uint StreamIdleInterval = 1000;
+
+	// Samples of each quantity the scout generates at a time.
+	static const Uint SampleBlock = 128;
+
 private:
+	// Connects a SocketChannel to the TFC on the loopback address. Returns
+	// false on failure.
+	bool connectSocket(void);
+
+	// Carries out m_current, whose delay has passed, and schedules the next
+	// action on m_wheel. Never blocks waiting for the TFC.
+	void step(void);
+
+#if defined(__cpp_impl_coroutine)
+	// The behavior of update() as a coroutine on m_wheel: it awaits each
+	// action's delay and each reply instead of sleeping or blocking, so a
+	// waiting probe holds a small frame rather than a thread. Used in
+	// place of step() where the compiler supports it.
+	Coroutine behave(void);
+#endif
+
+	// Queues the start of the next cycle of behavior once the previous one
+	// has been carried out.
+	void plan(void);
+
+	// Queues the report of a batch of asteroids, the first discovered at
+	// TFC time.
+	void planReport(const Uint time);
+
+	// Queues the report of the next batch of m_field's asteroids, the
+	// first acknowledged at TFC time.
+	void planStreamReport(const Uint time);
+
+	// Queues attacks on the targets in a TARGETS_AVAILABLE message.
+	void planAttack(const Message& targets);
+
+	// Returns the next sample of a ScoutSampler::Stream, generating another
+	// SampleBlock of them once the last is used up.
+	const Uint nextSample(const Uint stream);
+
 	Uint m_id;
 	Uint m_type;
 	Uint m_state;
-	SOCKET m_socket;
+	std::unique_ptr<Channel> m_channel;
 	struct addrinfo* m_server;	
 	int m_weaponRechargeTime;
 	int m_weaponPower;
-	std::default_random_engine m_generator;
+	Uint m_batchSize;
+	// Asteroids discovered so far, used to number them.
+	Uint m_asteroidCount;
+	// Delay until the next discovery, if one was rolled for the last batch
+	// but left out of it, to wait before the next rather than roll again.
+	bool m_discoveryHeld;
+	Uint m_heldDiscoveryTime;
+	std::deque<Action> m_actions;
+	// Wheel driving the probe, and the action it is waiting to carry out.
+	TimerWheel* m_wheel;
+	Action m_current;
+	// Generates the scout's asteroid data, and the samples of each stream
+	// not yet handed out, from m_sampleNext on.
+	std::unique_ptr<ScoutSampler> m_sampler;
+	std::vector<Uint> m_samples[ScoutSampler::NUM_STREAMS];
+	Uint m_sampleNext[ScoutSampler::NUM_STREAMS];
+	// Field being streamed, if any, the next asteroid to report from it,
+	// and the recorded discovery time of the last one reported.
+	const AsteroidField* m_field;
+	Uint m_fieldNext;
+	Uint m_fieldTime;
+	bool m_fieldRealTime;
 };
 
 // ================================================ //
@@ -123,6 +298,18 @@ inline const Uint Probe::getState(void) const{
 
 // ================================================ //
 
+inline constexpr Uint Probe::WeaponRechargeTime(const Uint type){
+	return (type == Probe::Type::PHOTON) ? 3000 :
+		(type == Probe::Type::PHASER) ? 2000 : 0;
+}
+
+inline constexpr Uint Probe::WeaponPower(const Uint type){
+	return (type == Probe::Type::PHOTON) ? 5 :
+		(type == Probe::Type::PHASER) ? 3 : 0;
+}
+
+// ================================================ //
+
 #endif
 
 // ================================================ //
\ No newline at end of file
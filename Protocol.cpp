@@ -0,0 +1,113 @@
+// ================================================ //
+// File: Protocol.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements the wire framing for Probe::Message.
+// ================================================ //
+
+#include "Protocol.hpp"
+#include <cstddef>
+
+// ================================================ //
+
+void Frame::Encode(const Probe::Message& msg, std::vector<char>& out)
+{
+	Uint length = Frame::PayloadSize(msg);
+
+	FrameHeader header;
+	header.version = Frame::Version;
+	header.reserved = 0;
+	header.length = htons(static_cast<uint16_t>(length));
+
+	const char* h = reinterpret_cast<const char*>(&header);
+	const char* p = reinterpret_cast<const char*>(&msg);
+	out.insert(out.end(), h, h + sizeof(header));
+	out.insert(out.end(), p, p + length);
+}
+
+// ================================================ //
+
+const Uint Frame::PayloadSize(const Probe::Message& msg)
+{
+	switch (msg.type){
+	case Probe::MessageType::ASTEROIDS_FOUND:
+	case Probe::MessageType::TARGETS_AVAILABLE:
+		// Only the asteroids actually in the batch.
+		return static_cast<Uint>(offsetof(Probe::Message, Batch.asteroids) +
+			std::min<Uint>(msg.Batch.count, Probe::BatchMax) * sizeof(Asteroid));
+
+	case Probe::MessageType::LAUNCH_REQUEST:
+		return static_cast<Uint>(offsetof(Probe::Message, LaunchRequest) + 
+			sizeof(msg.LaunchRequest));
+
+	default:
+		return static_cast<Uint>(offsetof(Probe::Message, asteroid) + sizeof(Asteroid));
+	}
+}
+
+// ================================================ //
+
+FrameDecoder::FrameDecoder(void) :
+m_buffer(),
+m_offset(0),
+m_corrupt(false)
+{
+
+}
+
+// ================================================ //
+
+FrameDecoder::~FrameDecoder(void)
+{
+
+}
+
+// ================================================ //
+
+void FrameDecoder::append(const char* data, const size_t size)
+{
+	// Reclaim space used by frames already decoded.
+	if (m_offset > 0 && m_offset >= m_buffer.size() / 2){
+		m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_offset);
+		m_offset = 0;
+	}
+
+	m_buffer.insert(m_buffer.end(), data, data + size);
+}
+
+// ================================================ //
+
+bool FrameDecoder::next(Probe::Message& msg)
+{
+	if (m_corrupt || m_buffer.size() - m_offset < sizeof(FrameHeader)){
+		return false;
+	}
+
+	FrameHeader header;
+	memcpy(&header, &m_buffer[m_offset], sizeof(header));
+	Uint length = ntohs(header.length);
+	if (header.version != Frame::Version || length > sizeof(msg)){
+		m_corrupt = true;
+		return false;
+	}
+
+	if (m_buffer.size() - m_offset - sizeof(header) < length){
+		// Rest of the frame hasn't arrived yet.
+		return false;
+	}
+
+	// Short payloads leave the trailing fields zeroed.
+	ZeroMemory(&msg, sizeof(msg));
+	memcpy(&msg, &m_buffer[m_offset + sizeof(header)], length);
+	m_offset += sizeof(header) + length;
+
+	if (m_offset == m_buffer.size()){
+		m_buffer.clear();
+		m_offset = 0;
+	}
+
+	return true;
+}
+
+// ================================================ //
@@ -0,0 +1,91 @@
+// ================================================ //
+// File: Protocol.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines the wire framing for Probe::Message.
+// ================================================ //
+
+#ifndef __PROTOCOL_HPP__
+#define __PROTOCOL_HPP__
+
+// ================================================ //
+
+#include "Probe.hpp"
+
+// ================================================ //
+
+// Header preceding every message on the wire.
+struct FrameHeader{
+	// Protocol version, must equal Frame::Version.
+	uint8_t version;
+	uint8_t reserved;
+	// Number of payload bytes after the header, in network byte order.
+	uint16_t length;
+};
+
+// ================================================ //
+// Encoding of messages into frames. TCP is a byte stream, so a single recv()
+// may hold part of a message or several of them; each message is therefore
+// sent as a header carrying its length followed by that many bytes.
+class Frame
+{
+public:
+	// Appends msg to out as a header and payload. Any number of messages may
+	// be appended and then sent with one send().
+	static void Encode(const Probe::Message& msg, std::vector<char>& out);
+
+	// Returns number of payload bytes needed to carry msg.
+	static const Uint PayloadSize(const Probe::Message& msg);
+
+	// Current protocol version.
+	static const uint8_t Version = 1;
+};
+
+// ================================================ //
+// Reassembles frames from received bytes, one per connection.
+class FrameDecoder
+{
+public:
+	// Empty constructor.
+	explicit FrameDecoder(void);
+
+	// Empty destructor.
+	~FrameDecoder(void);
+
+	// Adds received bytes to the reassembly buffer.
+	void append(const char* data, const size_t size);
+
+	// Extracts the next whole message. Returns false if more bytes are
+	// needed, or if the stream is corrupt (see isCorrupt()).
+	bool next(Probe::Message& msg);
+
+	// Returns true if no received bytes are waiting to be decoded.
+	const bool empty(void) const;
+
+	// Returns true if a frame had a bad version or length. Nothing more can
+	// be decoded from the connection.
+	const bool isCorrupt(void) const;
+
+private:
+	std::vector<char> m_buffer;
+	// Start of the first undecoded byte in m_buffer.
+	size_t m_offset;
+	bool m_corrupt;
+};
+
+// ================================================ //
+
+inline const bool FrameDecoder::empty(void) const{
+	return (m_offset == m_buffer.size());
+}
+
+inline const bool FrameDecoder::isCorrupt(void) const{
+	return m_corrupt;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,448 @@
+// ================================================ //
+// File: Reactor.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements Reactor class.
+// ================================================ //
+
+#include "Reactor.hpp"
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+// ================================================ //
+
+// Storage for TickInterval, which std::chrono::milliseconds binds by
+// reference.
+const int Reactor::TickInterval;
+
+// ================================================ //
+
+// Puts a socket in non-blocking mode.
+static void SetNonBlocking(const SOCKET socket)
+{
+#if defined(_WIN32)
+	u_long mode = 1;
+	ioctlsocket(socket, FIONBIO, &mode);
+#else
+	int flags = fcntl(socket, F_GETFL, 0);
+	fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+#endif
+}
+
+// ================================================ //
+
+// Returns true if the last socket call failed only because it would block.
+static bool WouldBlock(void)
+{
+#if defined(_WIN32)
+	return (WSAGetLastError() == WSAEWOULDBLOCK);
+#else
+	return (errno == EAGAIN || errno == EWOULDBLOCK);
+#endif
+}
+
+// ================================================ //
+
+// Restricts the calling thread to a single core.
+static void PinToCore(const int core)
+{
+#if defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << core);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+// ================================================ //
+
+Reactor::Reactor(TFC* tfc, const SOCKET listener, const int core) :
+m_tfc(tfc),
+m_listener(listener),
+m_core(core),
+m_connections(),
+m_scout(INVALID_SOCKET),
+m_held(),
+m_inField(false),
+m_stopped(false)
+#if defined(__linux__)
+,m_epoll(epoll_create1(0)),
+m_wakeup(eventfd(0, EFD_NONBLOCK))
+#endif
+{
+	SetNonBlocking(m_listener);
+
+#if defined(__linux__)
+	struct epoll_event ev;
+	ZeroMemory(&ev, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = m_listener;
+	epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listener, &ev);
+
+	ZeroMemory(&ev, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = m_wakeup;
+	epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &ev);
+#endif
+}
+
+// ================================================ //
+
+Reactor::~Reactor(void)
+{
+	while (m_connections.empty() == false){
+		this->disconnect(m_connections.begin()->first);
+	}
+
+#if defined(__linux__)
+	::close(m_wakeup);
+	::close(m_epoll);
+#endif
+}
+
+// ================================================ //
+
+void Reactor::run(void)
+{
+	if (m_core >= 0){
+		PinToCore(m_core);
+	}
+
+	// Wait for events no longer than until the next tick is due, so a busy
+	// reactor ticks no more often than an idle one.
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point nextTick = Clock::now() +
+		std::chrono::milliseconds(Reactor::TickInterval);
+	while (m_tfc->isFleetAlive() && m_stopped == false){
+		int timeout = static_cast<int>(std::max<int64_t>(0,
+			std::chrono::duration_cast<std::chrono::milliseconds>(
+			nextTick - Clock::now()).count()));
+#if defined(__linux__)
+		struct epoll_event events[64];
+		int n = epoll_wait(m_epoll, events, 64, timeout);
+		for (int i = 0; i < n; ++i){
+			SOCKET socket = events[i].data.fd;
+			Uint flags = events[i].events;
+			bool readable = (flags & (EPOLLIN | EPOLLRDHUP)) != 0;
+			bool writable = (flags & EPOLLOUT) != 0;
+			bool failed = (flags & (EPOLLERR | EPOLLHUP)) != 0;
+			if (socket == m_wakeup){
+				// Left readable; the loop ends once this pass is done.
+				continue;
+			}
+#else
+		// Rebuild the poll set each pass; only ask for writability when
+		// there is something queued.
+		std::vector<WSAPOLLFD> fds;
+		fds.reserve(m_connections.size() + 1);
+		WSAPOLLFD pfd;
+		pfd.fd = m_listener;
+		pfd.events = POLLRDNORM;
+		pfd.revents = 0;
+		fds.push_back(pfd);
+		for (std::unordered_map<SOCKET, std::unique_ptr<Connection>>::iterator itr =
+			 m_connections.begin(); itr != m_connections.end(); ++itr){
+			pfd.fd = itr->first;
+			pfd.events = POLLRDNORM | ((itr->second->out.empty()) ? 0 : POLLWRNORM);
+			fds.push_back(pfd);
+		}
+
+		int n = WSAPoll(&fds[0], static_cast<ULONG>(fds.size()), timeout);
+		for (size_t i = 0; n > 0 && i < fds.size(); ++i){
+			if (fds[i].revents == 0){
+				continue;
+			}
+			SOCKET socket = fds[i].fd;
+			bool readable = (fds[i].revents & (POLLRDNORM | POLLHUP)) != 0;
+			bool writable = (fds[i].revents & POLLWRNORM) != 0;
+			bool failed = (fds[i].revents & (POLLERR | POLLNVAL)) != 0;
+#endif
+			if (socket == m_listener){
+				this->acceptAll();
+				continue;
+			}
+
+			std::unordered_map<SOCKET, std::unique_ptr<Connection>>::iterator itr =
+				m_connections.find(socket);
+			if (itr == m_connections.end()){
+				continue;
+			}
+
+			// Drain input before honoring a hangup so a final TERMINATED
+			// is still processed.
+			Connection& c = *itr->second;
+			bool ok = true;
+			if (readable){
+				ok = this->onReadable(c);
+			}
+			if (ok && writable){
+				ok = this->flush(c);
+			}
+			if (ok == false || (failed && readable == false)){
+				this->disconnect(socket);
+			}
+		}
+
+		// On entering the field, serve what was held back and activate the
+		// scout straight away rather than at the next tick.
+		bool inField = m_tfc->isInAsteroidField();
+		if (inField && m_inField == false){
+			this->releaseHeld();
+			this->tick();
+		}
+		m_inField = inField;
+
+		if (Clock::now() >= nextTick){
+			this->tick();
+			nextTick = Clock::now() + std::chrono::milliseconds(Reactor::TickInterval);
+		}
+	}
+}
+
+// ================================================ //
+
+void Reactor::stop(void)
+{
+	m_stopped = true;
+#if defined(__linux__)
+	uint64_t one = 1;
+	ssize_t written = ::write(m_wakeup, &one, sizeof(one));
+	(void)written;
+#endif
+}
+
+// ================================================ //
+
+void Reactor::acceptAll(void)
+{
+	for (;;){
+		SOCKET socket = accept(m_listener, nullptr, nullptr);
+		if (socket == INVALID_SOCKET){
+			if (WouldBlock() == false){
+				printf("TFC: accept() failed: %ld\n", static_cast<long>(WSAGetLastError()));
+			}
+			return;
+		}
+
+		SetNonBlocking(socket);
+
+		std::unique_ptr<Connection> c(new Connection());
+		c->probe.socket = socket;
+		c->probe.id = 0;
+		c->probe.type = 0;
+		c->launched = false;
+		c->held = false;
+
+#if defined(__linux__)
+		// Edge-triggered, so reads and writes always run until they would block.
+		struct epoll_event ev;
+		ZeroMemory(&ev, sizeof(ev));
+		ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		ev.data.fd = socket;
+		epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &ev);
+#endif
+
+		m_connections[socket] = std::move(c);
+	}
+}
+
+// ================================================ //
+
+bool Reactor::onReadable(Connection& c)
+{
+	bool open = true;
+	char buffer[4096];
+	for (;;){
+		int r = recv(c.probe.socket, buffer, sizeof(buffer), 0);
+		if (r > 0){
+			c.decoder.append(buffer, r);
+		}
+		else{
+			// Zero means the probe hung up; anything else but a would-block
+			// is an error.
+			open = (r < 0 && WouldBlock());
+			break;
+		}
+	}
+
+	Probe::Message msg;
+	while (c.decoder.next(msg)){
+		c.pending.push_back(msg);
+	}
+	if (c.decoder.isCorrupt()){
+		printf("TFC: malformed frame on socket %ld\n", static_cast<long>(c.probe.socket));
+		return false;
+	}
+
+	return (this->dispatch(c) && open);
+}
+
+// ================================================ //
+
+bool Reactor::dispatch(Connection& c)
+{
+	std::vector<Probe::Message> replies;
+	bool alive = true;
+	while (alive && c.pending.empty() == false){
+		const Probe::Message& msg = c.pending.front();
+		if (c.launched == false){
+			// The first message must be a launch request, and launches are
+			// not allowed while navigating the asteroid field.
+			if (msg.type != Probe::MessageType::LAUNCH_REQUEST ||
+				m_tfc->isInAsteroidField()){
+				return false;
+			}
+
+			// Shared memory isn't offered here, the confirmation leaves the
+			// transport as SOCKET_STREAM and the probe stays on its socket.
+			Probe::Message confirm;
+			c.probe = m_tfc->registerProbe(c.probe.socket, msg.LaunchRequest.type,
+										   confirm);
+			c.launched = true;
+			if (c.probe.type == Probe::Type::SCOUT){
+				m_scout = c.probe.socket;
+			}
+			replies.push_back(confirm);
+		}
+		else if (m_tfc->isInAsteroidField()){
+			alive = m_tfc->handleMessage(c.probe, msg, replies);
+		}
+		else{
+			// Hold requests until the TFC engages the asteroid field, the
+			// same as the threaded server which doesn't read them until then.
+			if (c.held == false){
+				c.held = true;
+				m_held.push_back(c.probe.socket);
+			}
+			break;
+		}
+		c.pending.pop_front();
+	}
+
+	bool ok = this->queue(c, replies);
+
+	return (ok && alive);
+}
+
+// ================================================ //
+
+bool Reactor::flush(Connection& c)
+{
+	size_t sent = 0;
+	while (sent < c.out.size()){
+		int s = send(c.probe.socket, &c.out[sent], static_cast<int>(c.out.size() - sent),
+					 MSG_NOSIGNAL);
+		if (s > 0){
+			sent += s;
+		}
+		else if (s < 0 && WouldBlock()){
+			// Resume when the socket reports writable again.
+			break;
+		}
+		else{
+			return false;
+		}
+	}
+
+	c.out.erase(c.out.begin(), c.out.begin() + sent);
+	return true;
+}
+
+// ================================================ //
+
+bool Reactor::queue(Connection& c, std::vector<Probe::Message>& msgs)
+{
+	if (msgs.empty()){
+		return true;
+	}
+
+	for (std::vector<Probe::Message>::iterator itr = msgs.begin(); 
+		 itr != msgs.end(); ++itr){
+		Frame::Encode(*itr, c.out);
+	}
+	msgs.clear();
+
+	return this->flush(c);
+}
+
+// ================================================ //
+
+void Reactor::disconnect(const SOCKET socket)
+{
+#if defined(__linux__)
+	epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, nullptr);
+#endif
+	closesocket(socket);
+	m_connections.erase(socket);
+	if (socket == m_scout){
+		m_scout = INVALID_SOCKET;
+	}
+}
+
+// ================================================ //
+
+void Reactor::releaseHeld(void)
+{
+	// Taken first, as dispatching may hold requests again if the field has
+	// already been left.
+	std::vector<SOCKET> held;
+	held.swap(m_held);
+
+	std::vector<SOCKET> closed;
+	for (std::vector<SOCKET>::iterator itr = held.begin(); itr != held.end(); ++itr){
+		std::unordered_map<SOCKET, std::unique_ptr<Connection>>::iterator c =
+			m_connections.find(*itr);
+		if (c == m_connections.end()){
+			// Closed since.
+			continue;
+		}
+
+		c->second->held = false;
+		if (this->dispatch(*c->second) == false){
+			closed.push_back(*itr);
+		}
+	}
+
+	for (std::vector<SOCKET>::iterator itr = closed.begin(); itr != closed.end(); ++itr){
+		this->disconnect(*itr);
+	}
+}
+
+// ================================================ //
+
+void Reactor::tick(void)
+{
+	if (m_scout == INVALID_SOCKET || m_tfc->isInAsteroidField() == false){
+		return;
+	}
+
+	// Only allow the scout probe to check destruction conditions.
+	std::unordered_map<SOCKET, std::unique_ptr<Connection>>::iterator itr =
+		m_connections.find(m_scout);
+	if (itr == m_connections.end()){
+		return;
+	}
+
+	std::vector<Probe::Message> replies;
+	m_tfc->updateFieldStatus(replies);
+	if (this->queue(*itr->second, replies) == false){
+		this->disconnect(m_scout);
+	}
+}
+
+// ================================================ //
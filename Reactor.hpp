@@ -0,0 +1,110 @@
+// ================================================ //
+// File: Reactor.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Reactor class.
+// ================================================ //
+
+#ifndef __REACTOR_HPP__
+#define __REACTOR_HPP__
+
+// ================================================ //
+
+#include "TFC.hpp"
+#include "Protocol.hpp"
+#include <unordered_map>
+
+// ================================================ //
+// A single-threaded event loop serving probe connections for the TFC.
+// Sockets are non-blocking and multiplexed with epoll (edge-triggered) on
+// Linux, or WSAPoll elsewhere. Messages are dispatched to the same
+// TFC::handleMessage used by the thread-per-probe server. Several reactors
+// may run at once, each owning the connections it accepted.
+class Reactor
+{
+public:
+	// Makes listener non-blocking. The socket stays owned by the TFC. If
+	// core is not negative, run() pins its thread to that core.
+	explicit Reactor(TFC* tfc, const SOCKET listener, const int core = -1);
+
+	// Closes any remaining probe connections.
+	~Reactor(void);
+
+	// Runs the event loop until the fleet is destroyed or stop() is called.
+	void run(void);
+
+	// Makes run() return soon, from any thread: at once on Linux, where it
+	// signals an eventfd the loop watches, otherwise within TickInterval.
+	void stop(void);
+
+	// Time in ms between checks of fleet status on the scout's behalf.
+	static const int TickInterval = 100;
+
+private:
+	// Per-probe connection state.
+	struct Connection{
+		ProbeRecord probe;
+		// True once LAUNCH_REQUEST has been confirmed.
+		bool launched;
+		// Reassembles frames from received bytes.
+		FrameDecoder decoder;
+		// Decoded messages not yet handled.
+		std::deque<Probe::Message> pending;
+		// True once listed in m_held.
+		bool held;
+		// Framed bytes waiting for the socket to become writable.
+		std::vector<char> out;
+	};
+
+	// Accepts every pending connection on the listener.
+	void acceptAll(void);
+
+	// Reads and decodes everything available and dispatches it. Returns
+	// false if the connection should be closed.
+	bool onReadable(Connection& c);
+
+	// Handles every decoded message pending for c and queues the replies.
+	// Returns false if the connection should be closed.
+	bool dispatch(Connection& c);
+
+	// Writes as much queued output as the socket accepts. Returns false if
+	// the connection failed.
+	bool flush(Connection& c);
+
+	// Frames messages for c, empties the list and tries to send them.
+	// Returns false if the connection failed.
+	bool queue(Connection& c, std::vector<Probe::Message>& msgs);
+
+	// Stops watching and closes a connection.
+	void disconnect(const SOCKET socket);
+
+	// Serves the requests held back until the TFC entered the field.
+	void releaseHeld(void);
+
+	// Periodic work: lets the scout's connection drive fleet status.
+	void tick(void);
+
+	TFC* m_tfc;
+	SOCKET m_listener;
+	int m_core;
+	std::unordered_map<SOCKET, std::unique_ptr<Connection>> m_connections;
+	// The scout's connection, if this reactor accepted it.
+	SOCKET m_scout;
+	// Connections holding requests made before the field was entered.
+	std::vector<SOCKET> m_held;
+	// Whether the TFC was in the field as of the last pass.
+	bool m_inField;
+	std::atomic<bool> m_stopped;
+#if defined(__linux__)
+	int m_epoll;
+	// Signalled by stop() to end the wait for events.
+	int m_wakeup;
+#endif
+};
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,216 @@
+// ================================================ //
+// File: Replay.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements Replay class.
+// ================================================ //
+
+#include "Replay.hpp"
+#include "VirtualClock.hpp"
+#include "LatencyHistogram.hpp"
+#include <unordered_map>
+
+// ================================================ //
+
+// Counts a difference from the journal at record i.
+static void Diverge(Replay::Result& result, const Uint i)
+{
+	if (result.divergences++ == 0){
+		result.firstDivergence = i;
+	}
+}
+
+// Returns the IDs of the targets in a reply to a request for targets, in
+// either form.
+static const std::vector<uint64_t> Targets(const Probe::Message& reply)
+{
+	std::vector<uint64_t> ids;
+	if (reply.type == Probe::MessageType::TARGET_AVAILABLE){
+		ids.push_back(reply.asteroid.id);
+	}
+	else if (reply.type == Probe::MessageType::TARGETS_AVAILABLE){
+		Uint count = std::min<Uint>(reply.Batch.count, Probe::BatchMax);
+		for (Uint i = 0; i < count; ++i){
+			ids.push_back(reply.Batch.asteroids[i].id);
+		}
+	}
+
+	return ids;
+}
+
+// ================================================ //
+
+Replay::Replay(const Journal& journal, const Uint containerType) :
+m_journal(journal),
+m_containerType(containerType)
+{
+
+}
+
+// ================================================ //
+
+Replay::~Replay(void)
+{
+
+}
+
+// ================================================ //
+
+const Replay::Result Replay::run(void)
+{
+	Result result;
+	ZeroMemory(&result, sizeof(result));
+
+	VirtualClock clock;
+	TFC::Config config;
+	config.containerType = m_containerType;
+	config.serverMode = TFC::ServerMode::HEADLESS;
+	config.clock = &clock;
+	TFC tfc(config);
+
+	// The replayed TFC hands out its own IDs, so map the journal's to them.
+	std::unordered_map<Uint, ProbeRecord> probes;
+	std::vector<Probe::Message> replies;
+	// The replay's answer to each probe's last request for targets, and
+	// asteroids which have hit the fleet in the replay but not yet in the
+	// journal, by ID.
+	std::unordered_map<Uint, Probe::Message> answers;
+	std::unordered_map<uint64_t, Uint> collisions;
+	std::vector<GUIEvent> events;
+	// Virtual time at which the field was entered; TFC time counts from it.
+	Uint base = 0;
+	bool settled = false;
+
+	int64_t start = Telemetry::Now();
+	for (Uint i = 0; i < m_journal.getCount(); ++i){
+		const Journal::Record& r = m_journal.getRecord(i);
+		switch (r.type){
+		default:
+			break;
+
+		case Journal::RecordType::LAUNCH:
+			{
+				Probe::Message confirm;
+				clock.set(base + r.tick);
+				probes[r.probeID] = tfc.registerProbe(INVALID_SOCKET, r.probeType,
+													  confirm);
+				++result.probes;
+			}
+			break;
+
+		case Journal::RecordType::FIELD_ENTERED:
+			base = clock.now();
+			tfc.enterAsteroidField();
+			break;
+
+		case Journal::RecordType::MESSAGE:
+			{
+				std::unordered_map<Uint, ProbeRecord>::iterator itr =
+					probes.find(r.probeID);
+				if (itr == probes.end()){
+					// Launched before the journal was opened.
+					Probe::Message confirm;
+					itr = probes.insert(std::make_pair(r.probeID,
+						tfc.registerProbe(INVALID_SOCKET, r.probeType, confirm))).first;
+					++result.probes;
+				}
+
+				clock.set(base + r.tick);
+				result.time = r.tick;
+
+				replies.clear();
+				tfc.handleMessage(itr->second, r.msg, replies);
+				++result.messages;
+				if ((r.msg.type == Probe::MessageType::DEFENSIVE_REQUEST ||
+					 r.msg.type == Probe::MessageType::DEFENSIVE_BATCH_REQUEST) &&
+					replies.empty() == false){
+					answers[r.probeID] = replies.back();
+				}
+
+				events.clear();
+				tfc.drainGUIEvents(events);
+				for (std::vector<GUIEvent>::iterator e = events.begin(); 
+					 e != events.end(); ++e){
+					if (e->type == GUIEventType::ASTEROID_COLLISION){
+						++collisions[e->id];
+					}
+				}
+			}
+			break;
+
+		case Journal::RecordType::TARGETS:
+			{
+				++result.decisions;
+				std::unordered_map<Uint, Probe::Message>::iterator itr =
+					answers.find(r.probeID);
+				if (itr == answers.end() || Targets(itr->second) != Targets(r.msg)){
+					Diverge(result, i);
+				}
+				if (itr != answers.end()){
+					answers.erase(itr);
+				}
+			}
+			break;
+
+		case Journal::RecordType::COLLISION:
+			{
+				++result.decisions;
+				std::unordered_map<uint64_t, Uint>::iterator itr =
+					collisions.find(r.msg.asteroid.id);
+				if (itr == collisions.end()){
+					Diverge(result, i);
+				}
+				else if (--itr->second == 0){
+					collisions.erase(itr);
+				}
+			}
+			break;
+
+		case Journal::RecordType::FLEET_SURVIVED:
+		case Journal::RecordType::FLEET_DESTROYED:
+			{
+				// The scout's check which decided the outcome live.
+				++result.decisions;
+				clock.set(base + r.tick);
+				replies.clear();
+				tfc.updateFieldStatus(replies);
+				bool survived = (r.type == Journal::RecordType::FLEET_SURVIVED);
+				if (tfc.isInAsteroidField() || tfc.isFleetAlive() != survived){
+					Diverge(result, i);
+				}
+
+				// Report the outcome as the live run does, on leaving.
+				if (settled == false){
+					settled = true;
+					result.survived = (tfc.isFleetAlive() && tfc.isInAsteroidField() == false);
+					result.shields = static_cast<int>(tfc.getShields());
+					result.asteroidsDestroyed = tfc.getNumAsteroidsDestroyed();
+				}
+			}
+			break;
+		}
+	}
+	result.elapsed = Telemetry::Now() - start;
+
+	// Any collision the journal never had.
+	for (std::unordered_map<uint64_t, Uint>::iterator itr = collisions.begin();
+		 itr != collisions.end(); ++itr){
+		for (Uint n = 0; n < itr->second; ++n){
+			Diverge(result, m_journal.getCount());
+		}
+	}
+
+	if (settled == false){
+		// Settle the outcome as the scout's next check would have.
+		replies.clear();
+		tfc.updateFieldStatus(replies);
+		result.survived = (tfc.isFleetAlive() && tfc.isInAsteroidField() == false);
+		result.shields = static_cast<int>(tfc.getShields());
+		result.asteroidsDestroyed = tfc.getNumAsteroidsDestroyed();
+	}
+
+	return result;
+}
+
+// ================================================ //
@@ -0,0 +1,69 @@
+// ================================================ //
+// File: Replay.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Replay class.
+// ================================================ //
+
+#ifndef __REPLAY_HPP__
+#define __REPLAY_HPP__
+
+// ================================================ //
+
+#include "TFC.hpp"
+#include "Journal.hpp"
+
+// ================================================ //
+// Re-executes a Journal against a fresh headless TFC on the calling thread,
+// as fast as it will go. Records are applied in journal order with the
+// TFC's virtual clock set to each one's recorded time, so a given journal
+// always replays the same way; the TFC's latency telemetry then measures
+// the handlers alone against identical input. Messages about asteroids
+// were journaled as the live TFC served them, even those which waited on
+// it, so the replay meets them in the same container; each decision the
+// live TFC journaled (targets handed out, collisions and the outcome) is
+// checked against the replay's own, and any difference counted.
+class Replay
+{
+public:
+	// Outcome of a replay.
+	struct Result{
+		// True if the fleet made it through the asteroid field.
+		bool survived;
+		int shields;
+		Uint asteroidsDestroyed;
+		Uint probes;
+		Uint messages;
+		// TFC time of the last record (ms).
+		Uint time;
+		// Decisions in the journal, and how many the replay made otherwise.
+		Uint decisions;
+		Uint divergences;
+		// Index of the first record the replay diverged at, if it did.
+		Uint firstDivergence;
+		// Wall clock time the replay took (ns).
+		int64_t elapsed;
+	};
+
+	// The journal must outlive the replay. containerType selects the
+	// AsteroidContainer, which the journal doesn't record.
+	explicit Replay(const Journal& journal,
+					const Uint containerType = AsteroidContainer::Type::PRIORITY);
+
+	// Empty destructor.
+	~Replay(void);
+
+	// Replays the whole journal. May be called again.
+	const Result run(void);
+
+private:
+	const Journal& m_journal;
+	Uint m_containerType;
+};
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,177 @@
+// ================================================ //
+// File: RingBuffer.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines RingBuffer class, a lock-free bounded
+// multi-producer/multi-consumer queue.
+// ================================================ //
+
+#ifndef __RINGBUFFER_HPP__
+#define __RINGBUFFER_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// ================================================ //
+// A bounded MPMC queue with sequence-numbered slots. Each slot carries a
+// sequence number which tells producers and consumers whether the slot is
+// ready for them, so a push or pop is a single CAS on head or tail with no
+// locks. Head and tail live on separate cache lines.
+template<typename T>
+class RingBuffer
+{
+public:
+	// Allocates the slots. Capacity is rounded up to a power of two.
+	explicit RingBuffer(const Uint capacity);
+
+	// Frees the slots.
+	~RingBuffer(void);
+
+	// Pushes an item onto the tail. Returns false if the buffer is full.
+	bool push(const T& item);
+
+	// Pops an item off the head. Returns false if the buffer is empty.
+	bool pop(T& item);
+
+	// Returns approximate number of items in buffer.
+	const Uint size(void) const;
+
+	// Returns number of slots in buffer.
+	const Uint capacity(void) const;
+
+private:
+	// Not copyable.
+	RingBuffer(const RingBuffer&);
+	RingBuffer& operator=(const RingBuffer&);
+
+	struct Cell{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	Cell* m_buffer;
+	size_t m_mask;
+	char m_pad0[CACHE_LINE_SIZE];
+	std::atomic<size_t> m_tail;
+	char m_pad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> m_head;
+	char m_pad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+};
+
+// ================================================ //
+
+template<typename T>
+RingBuffer<T>::RingBuffer(const Uint capacity) :
+m_buffer(nullptr),
+m_mask(0),
+m_tail(0),
+m_head(0)
+{
+	size_t size = 2;
+	while (size < capacity){
+		size <<= 1;
+	}
+
+	m_buffer = new Cell[size];
+	m_mask = size - 1;
+	for (size_t i = 0; i < size; ++i){
+		m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+// ================================================ //
+
+template<typename T>
+RingBuffer<T>::~RingBuffer(void)
+{
+	delete[] m_buffer;
+}
+
+// ================================================ //
+
+template<typename T>
+bool RingBuffer<T>::push(const T& item)
+{
+	Cell* cell = nullptr;
+	size_t pos = m_tail.load(std::memory_order_relaxed);
+	for (;;){
+		cell = &m_buffer[pos & m_mask];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+		if (diff == 0){
+			// Slot is free, try to claim it.
+			if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+				break;
+			}
+		}
+		else if (diff < 0){
+			// Slot still holds an item from the previous lap.
+			return false;
+		}
+		else{
+			// Another producer claimed it, reload.
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->data = item;
+	// Publish to consumers.
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+// ================================================ //
+
+template<typename T>
+bool RingBuffer<T>::pop(T& item)
+{
+	Cell* cell = nullptr;
+	size_t pos = m_head.load(std::memory_order_relaxed);
+	for (;;){
+		cell = &m_buffer[pos & m_mask];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+		if (diff == 0){
+			// Slot is filled, try to claim it.
+			if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+				break;
+			}
+		}
+		else if (diff < 0){
+			// Nothing published yet.
+			return false;
+		}
+		else{
+			pos = m_head.load(std::memory_order_relaxed);
+		}
+	}
+
+	item = cell->data;
+	// Hand the slot back to producers for the next lap.
+	cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+
+	return true;
+}
+
+// ================================================ //
+
+template<typename T>
+inline const Uint RingBuffer<T>::size(void) const{
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	size_t head = m_head.load(std::memory_order_relaxed);
+	return (tail > head) ? static_cast<Uint>(tail - head) : 0;
+}
+
+template<typename T>
+inline const Uint RingBuffer<T>::capacity(void) const{
+	return static_cast<Uint>(m_mask + 1);
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
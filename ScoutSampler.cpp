@@ -0,0 +1,335 @@
+// ================================================ //
+// File: ScoutSampler.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements ScoutSampler class.
+// ================================================ //
+
+#include "ScoutSampler.hpp"
+#include <climits>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ================================================ //
+
+// Segments of the discovery delay's inverse CDF, in units of the mean:
+// up to upper thousandths of probability the deviate is
+// (x - x0) * slope + y0.
+struct Segment{
+	Uint upper;
+	double x0, slope, y0;
+};
+
+static const Segment Segments[] = {
+	{ 100, 0.0, 1.04, 0.0 },
+	{ 200, 0.1, 1.18, 0.104 },
+	{ 300, 0.2, 1.33, 0.222 },
+	{ 400, 0.3, 1.54, 0.355 },
+	{ 500, 0.4, 1.81, 0.509 },
+	{ 600, 0.5, 2.25, 0.690 },
+	{ 700, 0.6, 2.85, 0.915 },
+	{ 750, 0.70, 3.60, 1.2 },
+	{ 800, 0.75, 4.40, 1.38 },
+	{ 840, 0.8, 5.75, 1.60 },
+	{ 880, 0.84, 7.25, 1.83 },
+	{ 900, 0.88, 9.00, 2.12 },
+	{ 920, 0.90, 11.0, 2.30 },
+	{ 940, 0.92, 14.5, 2.52 },
+	{ 950, 0.94, 18.0, 2.81 },
+	{ 960, 0.95, 21.0, 2.99 },
+	{ 970, 0.96, 30.0, 3.20 },
+	{ 980, 0.97, 40.0, 3.50 },
+	{ 990, 0.98, 70.0, 3.90 },
+	{ 995, 0.99, 140.0, 4.60 },
+	{ 998, 0.995, 300.0, 5.30 },
+	{ 999, 0.998, 800.0, 6.20 },
+	{ 1000, 0.9997, 1000.0, 8.0 }
+};
+
+// Mean discovery delay (ms) the deviates are scaled by.
+static const double DiscoveryMean = 4000.0;
+
+// Scales a 32-bit random number to [0, 1).
+static const double UnitScale = 1.0 / 4294967296.0;
+
+// Asteroid masses and the probabilities below which each is chosen.
+static const Uint Masses[] = { 3, 6, 9, 11 };
+static const double MassSteps[] = { 0.2, 0.5, 0.7 };
+
+// Range of times to impact (ms).
+static const Uint ImpactRange = 15000;
+
+// ================================================ //
+
+// Segment coefficients per table cell, stored by field so the vector path
+// can gather each.
+struct DiscoveryTable{
+	double x0[ScoutSampler::Cells];
+	double slope[ScoutSampler::Cells];
+	double y0[ScoutSampler::Cells];
+
+	DiscoveryTable(void){
+		Uint s = 0;
+		for (Uint c = 0; c < ScoutSampler::Cells; ++c){
+			while (c >= Segments[s].upper){
+				++s;
+			}
+			x0[c] = Segments[s].x0;
+			slope[c] = Segments[s].slope;
+			y0[c] = Segments[s].y0;
+		}
+	}
+};
+
+static const DiscoveryTable& Table(void)
+{
+	static const DiscoveryTable table;
+	return table;
+}
+
+// ================================================ //
+
+// Bijective 32-bit integer hash (lowbias32).
+static inline uint32_t Mix(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7FEB352DU;
+	x ^= x >> 15;
+	x *= 0x846CA68BU;
+	x ^= x >> 16;
+	return x;
+}
+
+// Returns (u * k) >> 32.
+static inline uint32_t MulHi(const uint32_t u, const uint32_t k)
+{
+	return static_cast<uint32_t>((static_cast<uint64_t>(u) * k) >> 32);
+}
+
+// Returns the smallest 32-bit random number at or above probability p.
+static inline uint32_t Threshold(const double p)
+{
+	return static_cast<uint32_t>(std::ceil(p / UnitScale));
+}
+
+// Returns the discovery delay (ms) for random number u.
+static inline Uint DiscoveryFromRandom(const DiscoveryTable& t, const uint32_t u)
+{
+	double x = u * UnitScale;
+	Uint c = MulHi(u, ScoutSampler::Cells);
+	return static_cast<Uint>(((x - t.x0[c]) * t.slope[c] + t.y0[c]) * DiscoveryMean);
+}
+
+// Returns the asteroid mass for random number u.
+static inline Uint MassFromRandom(const uint32_t u, const uint32_t* thresholds)
+{
+	Uint i = 0;
+	i += (u >= thresholds[0]);
+	i += (u >= thresholds[1]);
+	i += (u >= thresholds[2]);
+	return Masses[i];
+}
+
+// ================================================ //
+
+#if defined(__AVX2__)
+
+static inline __m256i Mix(__m256i x)
+{
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x7FEB352DU)));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+	x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x846CA68BU)));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	return x;
+}
+
+// Returns random numbers index..index + 7 of a stream with keys k0, k1.
+static inline __m256i Random(const uint32_t k0, const uint32_t k1, const uint32_t index)
+{
+	__m256i i = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(index)),
+								 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	__m256i x = Mix(_mm256_xor_si256(i, _mm256_set1_epi32(static_cast<int>(k0))));
+	return Mix(_mm256_add_epi32(x, _mm256_set1_epi32(static_cast<int>(k1))));
+}
+
+// Returns (u * k) >> 32 in each lane.
+static inline __m256i MulHi(const __m256i u, const uint32_t k)
+{
+	__m256i kv = _mm256_set1_epi32(static_cast<int>(k));
+	// Even lanes' products land in 64-bit lanes, odd lanes' are shifted
+	// down to be multiplied the same way; keep the high halves of each.
+	__m256i even = _mm256_srli_epi64(_mm256_mul_epu32(u, kv), 32);
+	__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(u, 32), kv);
+	return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+// Returns the unsigned 32-bit lanes of half of u (after flipping the sign
+// bit, in biased) as doubles scaled to [0, 1).
+static inline __m256d ToUnit(const __m128i biased)
+{
+	__m256d d = _mm256_add_pd(_mm256_cvtepi32_pd(biased), _mm256_set1_pd(2147483648.0));
+	return _mm256_mul_pd(d, _mm256_set1_pd(UnitScale));
+}
+
+// Returns the discovery delays (ms) for four random numbers.
+static inline __m128i Discovery(const DiscoveryTable& t, const __m128i biased,
+								const __m128i cells)
+{
+	__m256d x = ToUnit(biased);
+	__m256d x0 = _mm256_i32gather_pd(t.x0, cells, 8);
+	__m256d slope = _mm256_i32gather_pd(t.slope, cells, 8);
+	__m256d y0 = _mm256_i32gather_pd(t.y0, cells, 8);
+	// Same operations, in the same order, as the scalar path.
+	__m256d d = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(x, x0), slope), y0);
+	return _mm256_cvttpd_epi32(_mm256_mul_pd(d, _mm256_set1_pd(DiscoveryMean)));
+}
+
+#endif
+
+// ================================================ //
+
+ScoutSampler::ScoutSampler(const uint64_t seed)
+{
+	// Spread the seed over each stream's keys (SplitMix64).
+	uint64_t state = seed;
+	for (Uint s = 0; s < NUM_STREAMS; ++s){
+		state += 0x9E3779B97F4A7C15ULL;
+		uint64_t z = state;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		z ^= z >> 31;
+		m_keys[s][0] = static_cast<uint32_t>(z);
+		m_keys[s][1] = static_cast<uint32_t>(z >> 32);
+		m_counters[s] = 0;
+	}
+}
+
+// ================================================ //
+
+ScoutSampler::~ScoutSampler(void)
+{
+
+}
+
+// ================================================ //
+
+void ScoutSampler::discoveryTimes(Uint* out, const Uint count)
+{
+	const DiscoveryTable& t = Table();
+	uint32_t base = m_counters[DISCOVERY];
+	Uint i = 0;
+
+#if defined(__AVX2__)
+	const uint32_t* k = m_keys[DISCOVERY];
+	for (; i + 8 <= count; i += 8){
+		__m256i u = Random(k[0], k[1], base + i);
+		__m256i cells = MulHi(u, Cells);
+		__m256i biased = _mm256_xor_si256(u, _mm256_set1_epi32(INT_MIN));
+
+		__m128i lo = Discovery(t, _mm256_castsi256_si128(biased),
+							   _mm256_castsi256_si128(cells));
+		__m128i hi = Discovery(t, _mm256_extracti128_si256(biased, 1),
+							   _mm256_extracti128_si256(cells, 1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+							_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1));
+	}
+#endif
+
+	for (; i < count; ++i){
+		out[i] = DiscoveryFromRandom(t, this->random(DISCOVERY, base + i));
+	}
+	m_counters[DISCOVERY] += count;
+}
+
+// ================================================ //
+
+void ScoutSampler::asteroidSizes(Uint* out, const Uint count)
+{
+	static const uint32_t thresholds[] = {
+		Threshold(MassSteps[0]), Threshold(MassSteps[1]), Threshold(MassSteps[2])
+	};
+	uint32_t base = m_counters[MASS];
+	Uint i = 0;
+
+#if defined(__AVX2__)
+	const uint32_t* k = m_keys[MASS];
+	// AVX2 only compares signed lanes, so flip the sign bits of both sides.
+	const __m256i sign = _mm256_set1_epi32(INT_MIN);
+	__m256i below[3];
+	for (Uint j = 0; j < 3; ++j){
+		below[j] = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(thresholds[j])), sign);
+	}
+	for (; i + 8 <= count; i += 8){
+		__m256i u = _mm256_xor_si256(Random(k[0], k[1], base + i), sign);
+		// Each comparison is all ones where u falls below the threshold;
+		// take the step back to the smaller mass for each.
+		__m256i mass = _mm256_set1_epi32(static_cast<int>(Masses[3]));
+		for (Uint j = 0; j < 3; ++j){
+			__m256i lt = _mm256_cmpgt_epi32(below[j], u);
+			__m256i step = _mm256_set1_epi32(static_cast<int>(Masses[j + 1] - Masses[j]));
+			mass = _mm256_sub_epi32(mass, _mm256_and_si256(lt, step));
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), mass);
+	}
+#endif
+
+	for (; i < count; ++i){
+		out[i] = MassFromRandom(this->random(MASS, base + i), thresholds);
+	}
+	m_counters[MASS] += count;
+}
+
+// ================================================ //
+
+void ScoutSampler::timesToImpact(Uint* out, const Uint count)
+{
+	uint32_t base = m_counters[IMPACT];
+	Uint i = 0;
+
+#if defined(__AVX2__)
+	const uint32_t* k = m_keys[IMPACT];
+	for (; i + 8 <= count; i += 8){
+		__m256i u = Random(k[0], k[1], base + i);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), MulHi(u, ImpactRange));
+	}
+#endif
+
+	for (; i < count; ++i){
+		out[i] = MulHi(this->random(IMPACT, base + i), ImpactRange);
+	}
+	m_counters[IMPACT] += count;
+}
+
+// ================================================ //
+
+const Uint ScoutSampler::DiscoveryTime(const double x)
+{
+	const DiscoveryTable& t = Table();
+	Uint c = std::min(static_cast<Uint>(x * Cells), Cells - 1);
+	return static_cast<Uint>(((x - t.x0[c]) * t.slope[c] + t.y0[c]) * DiscoveryMean);
+}
+
+// ================================================ //
+
+const bool ScoutSampler::IsVectorized(void)
+{
+#if defined(__AVX2__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+// ================================================ //
+
+const uint32_t ScoutSampler::random(const Uint stream, const uint32_t index) const
+{
+	return Mix(Mix(index ^ m_keys[stream][0]) + m_keys[stream][1]);
+}
+
+// ================================================ //
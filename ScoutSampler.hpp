@@ -0,0 +1,78 @@
+// ================================================ //
+// File: ScoutSampler.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines ScoutSampler class.
+// ================================================ //
+
+#ifndef __SCOUTSAMPLER_HPP__
+#define __SCOUTSAMPLER_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// ================================================ //
+// Generates the scout's random asteroid data in bulk: discovery delays,
+// masses and times to impact, with the same distributions as
+// Probe::scoutDiscoveryTime(), scoutAsteroidSize() and scoutTimeToImpact().
+// The discovery delay's piecewise-linear inverse CDF is precomputed as one
+// table cell per 0.001 of probability, each inside a single segment, so a
+// sample is a lookup instead of a walk down the segments. Random numbers
+// come from a counter-based generator, a hash of (seed, stream, index), so
+// every lane can compute its own without a serial dependency, and a
+// sampler's output depends only on its seed and how many of each it has
+// generated. Built with AVX2 the arrays are filled eight at a time; the
+// scalar path gives identical results.
+class ScoutSampler
+{
+public:
+	// Independent random number streams, one per quantity.
+	enum Stream{
+		DISCOVERY = 0,
+		MASS,
+		IMPACT,
+		NUM_STREAMS
+	};
+
+	// Derives each stream's key from seed.
+	explicit ScoutSampler(const uint64_t seed = 1);
+
+	// Empty destructor.
+	~ScoutSampler(void);
+
+	// Fills out with count delays until the next discovery (ms).
+	void discoveryTimes(Uint* out, const Uint count);
+
+	// Fills out with count asteroid masses.
+	void asteroidSizes(Uint* out, const Uint count);
+
+	// Fills out with count times to impact (ms).
+	void timesToImpact(Uint* out, const Uint count);
+
+	// Returns the discovery delay (ms) at probability x in [0, 1), from
+	// the precomputed table.
+	static const Uint DiscoveryTime(const double x);
+
+	// Returns true if built with the AVX2 path.
+	static const bool IsVectorized(void);
+
+	// Table cells, one per 0.001 of probability.
+	static const Uint Cells = 1000;
+
+private:
+	// Returns the index'th random number of stream.
+	const uint32_t random(const Uint stream, const uint32_t index) const;
+
+	// Hash keys of each stream.
+	uint32_t m_keys[NUM_STREAMS][2];
+	// Numbers taken from each stream so far.
+	uint32_t m_counters[NUM_STREAMS];
+};
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -8,12 +8,36 @@
 
 #include "Semaphore.hpp"
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
+
+// ================================================ //
+
+// Spin bounds for the adaptive fast path.
+static const int MinSpin = 16;
+static const int MaxSpin = 4000;
+
 // ================================================ //
 
 Semaphore::Semaphore(const Uint count) :
-m_count(count),
-m_mutex(),
+m_count(static_cast<int>(count)),
+m_spinLimit(MinSpin * 4),
+m_wakeups(0)
+#if !defined(__linux__)
+,m_mutex(),
 m_cr()
+#endif
 {
 
 }
@@ -29,23 +53,192 @@ Semaphore::~Semaphore(void)
 
 void Semaphore::wait(void)
 {
-	std::unique_lock<std::mutex> lock(m_mutex);
+	if (this->tryWait() || this->spin()){
+		return;
+	}
+
+	// Take a unit, or register as a waiter if there are none.
+	if (m_count.fetch_sub(1, std::memory_order_acquire) > 0){
+		return;
+	}
+
+	this->park(-1);
+}
+
+// ================================================ //
+
+bool Semaphore::waitFor(const Uint ms)
+{
+	if (this->tryWait() || this->spin()){
+		return true;
+	}
+
+	if (m_count.fetch_sub(1, std::memory_order_acquire) > 0){
+		return true;
+	}
+
+	if (this->park(static_cast<int>(ms))){
+		return true;
+	}
+
+	// Timed out, withdraw as a waiter. If the count went non-negative a
+	// signal() already counted us and its wakeup must be consumed.
+	int count = m_count.load(std::memory_order_relaxed);
+	while (count < 0){
+		if (m_count.compare_exchange_weak(count, count + 1, 
+										  std::memory_order_relaxed)){
+			return false;
+		}
+	}
+
+	this->park(-1);
+	return true;
+}
 
-	while (m_count == 0){
-		// Wait for next notify_one() in Semaphore::signal().
-		m_cr.wait(lock);
+// ================================================ //
+
+bool Semaphore::tryWait(void)
+{
+	int count = m_count.load(std::memory_order_relaxed);
+	while (count > 0){
+		if (m_count.compare_exchange_weak(count, count - 1, 
+										  std::memory_order_acquire,
+										  std::memory_order_relaxed)){
+			return true;
+		}
 	}
-	--m_count;
+
+	return false;
 }
 
 // ================================================ //
 
-void Semaphore::signal(void)
+void Semaphore::signal(const Uint n)
 {	
+	if (n == 0){
+		return;
+	}
+
+	int old = m_count.fetch_add(static_cast<int>(n), std::memory_order_release);
+	if (old < 0){
+		// Wake as many parked waiters as we have units for, in one go.
+		Uint waiters = static_cast<Uint>(-old);
+		this->unpark((waiters < n) ? waiters : n);
+	}
+}
+
+// ================================================ //
+
+bool Semaphore::spin(void)
+{
+	// Spinning only helps if another core can signal meanwhile.
+	static const bool multicore = (std::thread::hardware_concurrency() > 1);
+	if (multicore == false){
+		return false;
+	}
+
+	int limit = m_spinLimit.load(std::memory_order_relaxed);
+	for (int i = 0; i < limit; ++i){
+		CPU_RELAX();
+		if (this->tryWait()){
+			// Worth it, allow a little more next time.
+			if (limit < MaxSpin){
+				m_spinLimit.store(limit + limit / 8 + 1, std::memory_order_relaxed);
+			}
+			return true;
+		}
+	}
+
+	// Wasted effort, back off.
+	if (limit > MinSpin){
+		m_spinLimit.store(limit - limit / 8 - 1, std::memory_order_relaxed);
+	}
+
+	return false;
+}
+
+// ================================================ //
+
+#if defined(__linux__)
+
+bool Semaphore::park(const int ms)
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+		std::chrono::milliseconds((ms < 0) ? 0 : ms);
+
+	for (;;){
+		int wakeups = m_wakeups.load(std::memory_order_acquire);
+		while (wakeups > 0){
+			if (m_wakeups.compare_exchange_weak(wakeups, wakeups - 1, 
+												std::memory_order_acquire)){
+				return true;
+			}
+		}
+
+		struct timespec timeout;
+		struct timespec* pTimeout = nullptr;
+		if (ms >= 0){
+			std::chrono::nanoseconds left = deadline - std::chrono::steady_clock::now();
+			if (left.count() <= 0){
+				return false;
+			}
+			timeout.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+			timeout.tv_nsec = static_cast<long>(left.count() % 1000000000);
+			pTimeout = &timeout;
+		}
+
+		// Sleep only while there are still no wakeups.
+		syscall(SYS_futex, reinterpret_cast<int*>(&m_wakeups), FUTEX_WAIT_PRIVATE,
+				0, pTimeout, nullptr, 0);
+	}
+}
+
+// ================================================ //
+
+void Semaphore::unpark(const Uint n)
+{
+	m_wakeups.fetch_add(static_cast<int>(n), std::memory_order_release);
+	// One syscall releases all n waiters.
+	syscall(SYS_futex, reinterpret_cast<int*>(&m_wakeups), FUTEX_WAKE_PRIVATE,
+			static_cast<int>((n > INT_MAX) ? INT_MAX : n), nullptr, nullptr, 0);
+}
+
+#else
+
+bool Semaphore::park(const int ms)
+{
 	std::unique_lock<std::mutex> lock(m_mutex);
-	++m_count;
-	// Let next person in.
-	m_cr.notify_one();
+
+	if (ms < 0){
+		m_cr.wait(lock, [this]{ return m_wakeups > 0; });
+	}
+	else if (m_cr.wait_for(lock, std::chrono::milliseconds(ms), 
+						   [this]{ return m_wakeups > 0; }) == false){
+		return false;
+	}
+	--m_wakeups;
+
+	return true;
 }
 
-// ================================================ //
\ No newline at end of file
+// ================================================ //
+
+void Semaphore::unpark(const Uint n)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_wakeups += static_cast<int>(n);
+	}
+
+	// Notify outside the lock so woken threads don't immediately block on it.
+	if (n == 1){
+		m_cr.notify_one();
+	}
+	else{
+		m_cr.notify_all();
+	}
+}
+
+#endif
+
+// ================================================ //
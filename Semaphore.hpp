@@ -6,10 +6,17 @@
 // Defines Semaphore class.
 // ================================================ //
 
+#ifndef __SEMAPHORE_HPP__
+#define __SEMAPHORE_HPP__
+
+// ================================================ //
+
 #include "stdafx.hpp"
 
 // ================================================ //
-// A semaphore object using C++11 features.
+// A semaphore object using C++11 features. The count lives in an atomic so
+// uncontended wait/signal never take a lock; a thread only spins briefly and
+// then parks in the kernel (a futex on Linux) when the count is exhausted.
 class Semaphore
 {
 public:
@@ -22,13 +29,60 @@ public:
 	// Decrements count, if negative, calling process blocks.
 	void wait(void);
 
-	// Increments count, allows next blocking process in.
-	void signal(void);
+	// Same as wait(), but gives up after ms milliseconds. Returns false if
+	// timed out.
+	bool waitFor(const Uint ms);
+
+	// Decrements count if it is positive. Never blocks. Returns false if
+	// the count was zero.
+	bool tryWait(void);
+
+	// Increments count by n, allows up to n blocking processes in.
+	void signal(const Uint n = 1);
+
+	// Getters
+
+	// Returns the units a wait() could take without blocking, zero if
+	// threads are blocked. Never blocks.
+	const Uint getAvailable(void) const;
 
 private:
-	Uint m_count;
+	// Spins for a short, adaptive number of iterations trying to acquire.
+	// Returns true if acquired.
+	bool spin(void);
+
+	// Blocks until a wakeup is available and consumes it. A negative ms
+	// blocks forever. Returns false if timed out.
+	bool park(const int ms);
+
+	// Makes n wakeups available to parked threads.
+	void unpark(const Uint n);
+
+	// Available units, or negative number of parked waiters.
+	std::atomic<int> m_count;
+	// Current spin budget, grown when spinning pays off.
+	std::atomic<int> m_spinLimit;
+	// Wakeups granted by signal() but not yet consumed.
+#if defined(__linux__)
+	std::atomic<int> m_wakeups;
+#else
+	int m_wakeups;
 	std::mutex m_mutex;
 	std::condition_variable m_cr;
+#endif
 };
 
-// ================================================ //
\ No newline at end of file
+// ================================================ //
+
+// Getters
+
+inline const Uint Semaphore::getAvailable(void) const{
+	int count = m_count.load(std::memory_order_acquire);
+	return (count > 0) ? static_cast<Uint>(count) : 0;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
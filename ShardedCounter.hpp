@@ -0,0 +1,118 @@
+// ================================================ //
+// File: ShardedCounter.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines ShardedCounter class.
+// ================================================ //
+
+#ifndef __SHARDEDCOUNTER_HPP__
+#define __SHARDEDCOUNTER_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// ================================================ //
+// A counter incremented from many threads. Each thread adds to its own
+// shard, every shard on a separate cache line, so concurrent updates never
+// contend; a read sums the shards. Reads are not a snapshot, but a counter
+// that only grows is never read above its true value and settles on it
+// once the writers stop.
+class ShardedCounter
+{
+public:
+	// Sets the count to zero.
+	explicit ShardedCounter(void);
+
+	// Empty destructor.
+	~ShardedCounter(void);
+
+	// Adds n to the calling thread's shard.
+	void add(const int n = 1);
+
+	// Returns the sum of all shards.
+	const int get(void) const;
+
+	// Sets the count to zero. Not safe against concurrent add().
+	void reset(void);
+
+	// Number of shards; threads beyond this share them round-robin.
+	static const Uint Shards = 16;
+
+private:
+	// Not copyable.
+	ShardedCounter(const ShardedCounter&);
+	ShardedCounter& operator=(const ShardedCounter&);
+
+	struct Shard{
+		std::atomic<int> value;
+		char pad[CACHE_LINE_SIZE - sizeof(std::atomic<int>)];
+	};
+
+	// Returns the calling thread's shard, assigned on first use.
+	static const Uint ShardIndex(void);
+
+	// Keeps the first shard off the line of whatever precedes the counter.
+	char m_padBefore[CACHE_LINE_SIZE];
+	Shard m_shards[Shards];
+};
+
+// ================================================ //
+
+inline ShardedCounter::ShardedCounter(void)
+{
+	this->reset();
+}
+
+// ================================================ //
+
+inline ShardedCounter::~ShardedCounter(void)
+{
+
+}
+
+// ================================================ //
+
+inline void ShardedCounter::add(const int n)
+{
+	m_shards[ShardedCounter::ShardIndex()].value.fetch_add(n,
+		std::memory_order_relaxed);
+}
+
+// ================================================ //
+
+inline const int ShardedCounter::get(void) const
+{
+	int sum = 0;
+	for (Uint i = 0; i < Shards; ++i){
+		sum += m_shards[i].value.load(std::memory_order_relaxed);
+	}
+
+	return sum;
+}
+
+// ================================================ //
+
+inline void ShardedCounter::reset(void)
+{
+	for (Uint i = 0; i < Shards; ++i){
+		m_shards[i].value.store(0, std::memory_order_relaxed);
+	}
+}
+
+// ================================================ //
+
+inline const Uint ShardedCounter::ShardIndex(void)
+{
+	static std::atomic<Uint> next(0);
+	static thread_local Uint index = next++ % Shards;
+
+	return index;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
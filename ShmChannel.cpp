@@ -0,0 +1,480 @@
+// ================================================ //
+// File: ShmChannel.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements ShmChannel class.
+// ================================================ //
+
+#include "ShmChannel.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <climits>
+#endif
+
+// ================================================ //
+
+// Spins before sleeping on the futex; most replies arrive within it.
+static const int SpinLimit = 2000;
+
+// Identifies a mapped segment as a channel of this layout.
+static const uint32_t Magic = 0x4C324348;
+
+// ================================================ //
+
+struct ShmChannel::Ring{
+	// Total messages written, by the writer.
+	std::atomic<uint32_t> head;
+	char pad0[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+	// Total messages read, by the reader.
+	std::atomic<uint32_t> tail;
+	// Nonzero while the reader is, or is about to be, asleep.
+	std::atomic<uint32_t> sleeping;
+	// The futex the reader sleeps on. Bumped by the writer when it finds
+	// the reader asleep, and by disconnect(), so a wakeup sent between the
+	// reader's last look and its sleep makes the sleep return at once.
+	std::atomic<uint32_t> wakeups;
+	char pad1[CACHE_LINE_SIZE - 3 * sizeof(std::atomic<uint32_t>)];
+	Probe::Message slots[ShmChannel::Capacity];
+};
+
+struct ShmChannel::Segment{
+	uint32_t magic;
+	// Set by either end to close the channel.
+	std::atomic<uint32_t> closed;
+	char pad[CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+	// Probe to TFC.
+	Ring up;
+	// TFC to probe.
+	Ring down;
+};
+
+// ================================================ //
+
+#if defined(__linux__)
+
+// Sleeps while *addr equals value. The segment may be mapped by two
+// processes, so the futex is not private.
+static void FutexWait(std::atomic<uint32_t>* addr, const uint32_t value)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, value,
+			nullptr, nullptr, 0);
+}
+
+// Wakes every thread asleep on addr.
+static void FutexWake(std::atomic<uint32_t>* addr)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX,
+			nullptr, nullptr, 0);
+}
+
+#endif
+
+// ================================================ //
+
+ShmChannel::Waiters::Waiters(void) :
+callback(),
+onReady(false),
+waiterMutex(),
+waiter(),
+waiting(false)
+{
+
+}
+
+// ================================================ //
+
+ShmChannel::ShmChannel(void) :
+m_segment(nullptr),
+m_out(nullptr),
+m_in(nullptr),
+m_name(),
+m_owner(false),
+m_bell()
+{
+
+}
+
+// ================================================ //
+
+ShmChannel::~ShmChannel(void)
+{
+	this->disconnect();
+	this->unlink();
+#if defined(__linux__)
+	if (m_segment != nullptr){
+		munmap(m_segment, sizeof(Segment));
+	}
+#endif
+}
+
+// ================================================ //
+
+bool ShmChannel::create(void)
+{
+#if defined(__linux__)
+	static std::atomic<Uint> counter(0);
+	m_name = "/lab2." + toString(getpid()) + "." + toString(counter++);
+
+	int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0){
+		return false;
+	}
+	m_owner = true;
+
+	if (ftruncate(fd, sizeof(Segment)) != 0 || this->map(fd) == false){
+		::close(fd);
+		this->unlink();
+		return false;
+	}
+	::close(fd);
+
+	// A new segment is zero filled, so only the rings' ends need choosing.
+	m_out = &m_segment->up;
+	m_in = &m_segment->down;
+	m_segment->magic = Magic;
+
+	m_bell.reset(new Bell());
+	std::lock_guard<std::mutex> lock(ShmChannel::BellsMutex());
+	ShmChannel::Bells()[m_name] = m_bell;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// ================================================ //
+
+bool ShmChannel::attach(const std::string& name)
+{
+#if defined(__linux__)
+	int fd = shm_open(name.c_str(), O_RDWR, 0600);
+	if (fd < 0){
+		return false;
+	}
+
+	struct stat info;
+	bool ok = (fstat(fd, &info) == 0 &&
+			   info.st_size == static_cast<off_t>(sizeof(Segment)) &&
+			   this->map(fd));
+	::close(fd);
+	if (ok == false || m_segment->magic != Magic){
+		return false;
+	}
+
+	m_name = name;
+	m_out = &m_segment->down;
+	m_in = &m_segment->up;
+
+	// Created in this process?
+	std::lock_guard<std::mutex> lock(ShmChannel::BellsMutex());
+	std::unordered_map<std::string, std::weak_ptr<Bell>>::iterator itr =
+		ShmChannel::Bells().find(name);
+	if (itr != ShmChannel::Bells().end()){
+		m_bell = itr->second.lock();
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// ================================================ //
+
+void ShmChannel::unlink(void)
+{
+#if defined(__linux__)
+	if (m_owner){
+		shm_unlink(m_name.c_str());
+		m_owner = false;
+
+		std::lock_guard<std::mutex> lock(ShmChannel::BellsMutex());
+		ShmChannel::Bells().erase(m_name);
+	}
+#endif
+}
+
+// ================================================ //
+
+bool ShmChannel::send(const Probe::Message& msg)
+{
+	if (m_segment == nullptr){
+		return false;
+	}
+
+	while (this->push(*m_out, msg) == false){
+		if (m_segment->closed.load(std::memory_order_acquire)){
+			return false;
+		}
+		// Full; the reader is behind and awake.
+		std::this_thread::yield();
+	}
+	this->notify(*m_out);
+
+	return true;
+}
+
+// ================================================ //
+
+bool ShmChannel::send(const std::vector<Probe::Message>& msgs)
+{
+	if (m_segment == nullptr){
+		return false;
+	}
+
+	for (std::vector<Probe::Message>::const_iterator itr = msgs.begin();
+		 itr != msgs.end(); ++itr){
+		while (this->push(*m_out, *itr) == false){
+			if (m_segment->closed.load(std::memory_order_acquire)){
+				return false;
+			}
+			this->notify(*m_out);
+			std::this_thread::yield();
+		}
+	}
+	if (msgs.empty() == false){
+		this->notify(*m_out);
+	}
+
+	return true;
+}
+
+// ================================================ //
+
+bool ShmChannel::receive(Probe::Message& msg)
+{
+	if (m_segment == nullptr){
+		return false;
+	}
+
+	Ring& ring = *m_in;
+	uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+	int spins = 0;
+	for (;;){
+		uint32_t head = ring.head.load(std::memory_order_acquire);
+		if (head != tail){
+			break;
+		}
+		if (m_segment->closed.load(std::memory_order_acquire)){
+			return false;
+		}
+
+		if (spins < SpinLimit){
+			++spins;
+			continue;
+		}
+
+#if defined(__linux__)
+		// Announce the sleep, then look again so a message published
+		// before the writer saw the flag isn't missed. Anything after the
+		// look changes wakeups first.
+		ring.sleeping.store(1, std::memory_order_seq_cst);
+		uint32_t wakeups = ring.wakeups.load(std::memory_order_seq_cst);
+		if (ring.head.load(std::memory_order_seq_cst) == tail &&
+			m_segment->closed.load(std::memory_order_seq_cst) == 0){
+			FutexWait(&ring.wakeups, wakeups);
+		}
+		ring.sleeping.store(0, std::memory_order_relaxed);
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	msg = ring.slots[tail % Capacity];
+	ring.tail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+// ================================================ //
+
+bool ShmChannel::poll(void)
+{
+	if (m_segment == nullptr){
+		return true;
+	}
+
+	return (m_in->head.load(std::memory_order_acquire) !=
+			m_in->tail.load(std::memory_order_relaxed) ||
+			m_segment->closed.load(std::memory_order_acquire) != 0);
+}
+
+// ================================================ //
+
+void ShmChannel::disconnect(void)
+{
+	if (m_segment == nullptr || m_segment->closed.exchange(1) != 0){
+		return;
+	}
+
+#if defined(__linux__)
+	// Wake both readers so they see the channel closed, whether or not
+	// they have announced their sleep yet.
+	Ring* rings[2] = { &m_segment->up, &m_segment->down };
+	for (Uint i = 0; i < 2; ++i){
+		rings[i]->wakeups.fetch_add(1, std::memory_order_seq_cst);
+		FutexWake(&rings[i]->wakeups);
+	}
+#endif
+
+	if (m_bell){
+		ShmChannel::Announce(m_bell->ways[0]);
+		ShmChannel::Announce(m_bell->ways[1]);
+	}
+}
+
+// ================================================ //
+
+bool ShmChannel::setReadyCallback(const std::function<void(void)>& callback)
+{
+	if (m_bell == nullptr){
+		return false;
+	}
+
+	Waiters& way = this->waiters(*m_in);
+	way.callback = callback;
+	way.onReady.store(true, std::memory_order_release);
+
+	return true;
+}
+
+// ================================================ //
+
+bool ShmChannel::notifyWhenReady(const std::function<void(void)>& callback)
+{
+	if (m_bell == nullptr){
+		return false;
+	}
+
+	Waiters& way = this->waiters(*m_in);
+	{
+		std::lock_guard<std::mutex> lock(way.waiterMutex);
+		way.waiter = callback;
+		way.waiting = true;
+	}
+
+	// A message published before the writer could see the waiter would go
+	// unannounced, so look once more. Paired with the fence in Announce():
+	// either the writer sees waiting, or this sees the message.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (this->poll()){
+		ShmChannel::Wake(way);
+	}
+
+	return true;
+}
+
+// ================================================ //
+
+bool ShmChannel::map(const int fd)
+{
+#if defined(__linux__)
+	void* p = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED,
+				   fd, 0);
+	if (p == MAP_FAILED){
+		return false;
+	}
+
+	m_segment = static_cast<Segment*>(p);
+	return true;
+#else
+	(void)fd;
+	return false;
+#endif
+}
+
+// ================================================ //
+
+bool ShmChannel::push(Ring& ring, const Probe::Message& msg)
+{
+	uint32_t head = ring.head.load(std::memory_order_relaxed);
+	if (head - ring.tail.load(std::memory_order_acquire) >= Capacity){
+		return false;
+	}
+
+	ring.slots[head % Capacity] = msg;
+	// Publish; ordered before the check for a sleeping reader in notify().
+	ring.head.store(head + 1, std::memory_order_seq_cst);
+
+	return true;
+}
+
+// ================================================ //
+
+void ShmChannel::notify(Ring& ring)
+{
+#if defined(__linux__)
+	if (ring.sleeping.load(std::memory_order_seq_cst) != 0){
+		ring.wakeups.fetch_add(1, std::memory_order_seq_cst);
+		FutexWake(&ring.wakeups);
+	}
+#endif
+
+	if (m_bell){
+		ShmChannel::Announce(this->waiters(ring));
+	}
+}
+
+// ================================================ //
+
+std::unordered_map<std::string, std::weak_ptr<ShmChannel::Bell>>& ShmChannel::Bells(void)
+{
+	static std::unordered_map<std::string, std::weak_ptr<Bell>> bells;
+	return bells;
+}
+
+// ================================================ //
+
+std::mutex& ShmChannel::BellsMutex(void)
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+// ================================================ //
+
+ShmChannel::Waiters& ShmChannel::waiters(const Ring& ring)
+{
+	return m_bell->ways[(&ring == &m_segment->up) ? 0 : 1];
+}
+
+// ================================================ //
+
+void ShmChannel::Announce(Waiters& way)
+{
+	if (way.onReady.load(std::memory_order_acquire)){
+		way.callback();
+	}
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (way.waiting.load(std::memory_order_relaxed)){
+		ShmChannel::Wake(way);
+	}
+}
+
+// ================================================ //
+
+void ShmChannel::Wake(Waiters& way)
+{
+	std::function<void(void)> waiter;
+	{
+		std::lock_guard<std::mutex> lock(way.waiterMutex);
+		if (way.waiting == false){
+			// Taken by the other side.
+			return;
+		}
+		waiter.swap(way.waiter);
+		way.waiting = false;
+	}
+
+	waiter();
+}
+
+// ================================================ //
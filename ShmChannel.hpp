@@ -0,0 +1,160 @@
+// ================================================ //
+// File: ShmChannel.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines ShmChannel class.
+// ================================================ //
+
+#ifndef __SHMCHANNEL_HPP__
+#define __SHMCHANNEL_HPP__
+
+// ================================================ //
+
+#include "Channel.hpp"
+#include <unordered_map>
+
+// ================================================ //
+// Channel over a shared memory segment holding two single-producer,
+// single-consumer rings of messages, one each way. A message is copied
+// straight into a ring slot with no framing or system call; the reader
+// spins briefly and then sleeps on a futex which the writer only wakes when
+// someone is asleep. The segment is named so a TFC in another process on
+// the same host can attach to it. When both ends are in one process they
+// also share a Bell, through which a reader may ask to be called back
+// instead of blocking, as with LocalChannel. Only available on Linux;
+// elsewhere create() and attach() fail and callers stay on a
+// SocketChannel.
+class ShmChannel : public Channel
+{
+public:
+	// Creates an unopened channel.
+	explicit ShmChannel(void);
+
+	// Closes the channel and unmaps the segment.
+	virtual ~ShmChannel(void);
+
+	// Creates and maps a new segment as the probe end. Returns false if
+	// shared memory is unavailable.
+	bool create(void);
+
+	// Maps the segment created by a probe as the TFC end. Returns false if
+	// it doesn't exist or is not a channel.
+	bool attach(const std::string& name);
+
+	// Removes the segment's name so no one else can attach. The mapping
+	// stays valid until both ends are destroyed.
+	void unlink(void);
+
+	// Copies msg into the outgoing ring, waiting while the ring is full.
+	// Returns false if the channel is closed.
+	virtual bool send(const Probe::Message& msg);
+
+	// Sends every message in msgs, waking the reader at most once.
+	virtual bool send(const std::vector<Probe::Message>& msgs);
+
+	// Blocks until a message arrives. Returns false once the channel is
+	// closed and the ring is empty.
+	virtual bool receive(Probe::Message& msg);
+
+	// Returns true if a message is waiting or the channel is closed.
+	virtual bool poll(void);
+
+	// Marks the channel closed for both ends and wakes any waiter. Safe to
+	// call more than once.
+	virtual void disconnect(void);
+
+	// Runs callback after every message sent to this end, and on close,
+	// wherever the writer would wake a sleeping reader. Returns false if
+	// the other end is in another process.
+	virtual bool setReadyCallback(const std::function<void(void)>& callback);
+
+	// Runs callback once, after the next message sent to this end or on
+	// close, or right away if one is waiting already. Returns false if the
+	// other end is in another process.
+	virtual bool notifyWhenReady(const std::function<void(void)>& callback);
+
+	// Getters
+
+	// Returns the segment's name, for passing to attach().
+	const std::string& getName(void) const;
+
+	// Number of messages each ring holds.
+	static const Uint Capacity = 64;
+
+private:
+	// Not copyable.
+	ShmChannel(const ShmChannel&);
+	ShmChannel& operator=(const ShmChannel&);
+
+	struct Ring;
+	struct Segment;
+
+	// Callbacks for the reader of one ring (see LocalChannel::Direction).
+	struct Waiters{
+		Waiters(void);
+
+		// Run by the writer once onReady is set.
+		std::function<void(void)> callback;
+		std::atomic<bool> onReady;
+		// Run once by whichever of the writer or the reader sees a message
+		// first; waiting is set while one is held.
+		std::mutex waiterMutex;
+		std::function<void(void)> waiter;
+		std::atomic<bool> waiting;
+	};
+
+	// Shared by the two ends of a segment within one process, found by
+	// name. Indexed as the rings: up, then down.
+	struct Bell{
+		Waiters ways[2];
+	};
+
+	// Maps the segment open on fd. Returns false on failure.
+	bool map(const int fd);
+
+	// Copies msg into ring if there is room. Does not wake the reader.
+	bool push(Ring& ring, const Probe::Message& msg);
+
+	// Wakes the reader of ring if it is asleep, and runs its callbacks.
+	void notify(Ring& ring);
+
+	// Bells of the segments created in this process and not yet unlinked,
+	// by name, so an end attaching in the same process shares its
+	// creator's. Guarded by BellsMutex().
+	static std::unordered_map<std::string, std::weak_ptr<Bell>>& Bells(void);
+	static std::mutex& BellsMutex(void);
+
+	// Returns the callbacks for the reader of ring.
+	Waiters& waiters(const Ring& ring);
+
+	// Runs way's callback, if it has one, and its one-shot waiter, if one
+	// is held.
+	static void Announce(Waiters& way);
+
+	// Takes way's waiter, if it still holds one, and runs it.
+	static void Wake(Waiters& way);
+
+	Segment* m_segment;
+	// Rings written and read by this end.
+	Ring* m_out;
+	Ring* m_in;
+	std::string m_name;
+	bool m_owner;
+	// Null if the other end is in another process.
+	std::shared_ptr<Bell> m_bell;
+};
+
+// ================================================ //
+
+// Getters
+
+inline const std::string& ShmChannel::getName(void) const{
+	return m_name;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
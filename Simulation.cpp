@@ -0,0 +1,171 @@
+// ================================================ //
+// File: Simulation.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements Simulation class.
+// ================================================ //
+
+#include "Simulation.hpp"
+
+// ================================================ //
+
+// A probe action due at a point in simulated time. Ties are broken by
+// scheduling order so runs are deterministic.
+struct SimEvent{
+	Uint time;
+	Uint seq;
+	Uint probe;
+
+	bool operator>(const SimEvent& rhs) const{
+		return (time != rhs.time) ? (time > rhs.time) : (seq > rhs.seq);
+	}
+};
+
+// ================================================ //
+
+Simulation::Simulation(const Config& config) :
+m_config(config)
+{
+
+}
+
+// ================================================ //
+
+Simulation::~Simulation(void)
+{
+
+}
+
+// ================================================ //
+
+const Simulation::Result Simulation::run(void)
+{
+	Result result;
+	ZeroMemory(&result, sizeof(result));
+
+	VirtualClock clock;
+	TFC::Config config;
+	config.containerType = m_config.containerType;
+	config.serverMode = TFC::ServerMode::HEADLESS;
+	config.clock = &clock;
+	TFC tfc(config);
+
+	// Launch the fleet, scout first.
+	std::vector<std::unique_ptr<Probe>> probes;
+	probes.push_back(std::unique_ptr<Probe>(
+		new Probe(Probe::Type::SCOUT, m_config.batchSize)));
+	for (Uint i = 0; i < m_config.numPhotons; ++i){
+		probes.push_back(std::unique_ptr<Probe>(
+			new Probe(Probe::Type::PHOTON, m_config.batchSize)));
+	}
+	for (Uint i = 0; i < m_config.numPhasers; ++i){
+		probes.push_back(std::unique_ptr<Probe>(
+			new Probe(Probe::Type::PHASER, m_config.batchSize)));
+	}
+
+	std::vector<ProbeRecord> records;
+	for (Uint i = 0; i < probes.size(); ++i){
+		Probe::Message confirm;
+		Uint type = (i == 0) ? Probe::Type::SCOUT : 
+			(i <= m_config.numPhotons) ? Probe::Type::PHOTON : Probe::Type::PHASER;
+		records.push_back(tfc.registerProbe(INVALID_SOCKET, type, confirm));
+		probes[i]->onReply(confirm);
+		probes[i]->seed(m_config.seed * 7919 + i);
+	}
+	if (m_config.field != nullptr){
+		probes[0]->stream(m_config.field);
+	}
+
+	tfc.enterAsteroidField();
+
+	// Schedule each probe's first action.
+	std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+	std::vector<Probe::Action> pending(probes.size());
+	Uint seq = 0;
+	for (Uint i = 0; i < probes.size(); ++i){
+		pending[i] = probes[i]->nextAction();
+		SimEvent e = { pending[i].delay, seq++, i };
+		events.push(e);
+	}
+
+	std::vector<Probe::Message> replies;
+	while (events.empty() == false && tfc.isInAsteroidField()){
+		SimEvent e = events.top();
+		events.pop();
+		if (e.time > m_config.timeLimit){
+			break;
+		}
+
+		clock.set(e.time);
+		++result.events;
+
+		Probe& probe = *probes[e.probe];
+		Probe::Action& action = pending[e.probe];
+		const ProbeRecord& record = records[e.probe];
+
+		// Only the scout checks destruction conditions, as with the servers.
+		bool alive = true;
+		replies.clear();
+		if (record.type == Probe::Type::SCOUT){
+			tfc.updateFieldStatus(replies);
+		}
+		if (action.send){
+			alive = tfc.handleMessage(record, action.msg, replies);
+		}
+
+		// The headless TFC never blocks, so any reply is already here.
+		for (std::vector<Probe::Message>::iterator itr = replies.begin();
+			 itr != replies.end(); ++itr){
+			probe.onReply(*itr);
+		}
+
+		if (alive == false || probe.getState() == Probe::State::DESTROYED){
+			continue;
+		}
+
+		if (action.awaitReply && replies.empty()){
+			// Nothing to act on yet, keep waiting without sending again.
+			action.send = false;
+			action.delay = Simulation::PollInterval;
+		}
+		else{
+			action = probe.nextAction();
+		}
+
+		SimEvent next = { e.time + action.delay, seq++, e.probe };
+		events.push(next);
+	}
+
+	// Tally the run from the TFC's event log.
+	std::vector<GUIEvent> log;
+	tfc.drainGUIEvents(log);
+	for (std::vector<GUIEvent>::iterator itr = log.begin(); itr != log.end(); ++itr){
+		switch (itr->type){
+		default:
+			break;
+
+		case GUIEventType::ASTEROID_FOUND:
+			++result.asteroidsFound;
+			break;
+
+		case GUIEventType::ASTEROID_COLLISION:
+			++result.collisions;
+			break;
+
+		case GUIEventType::PROBE_TERMINATED:
+			++result.probesLost;
+			break;
+		}
+	}
+
+	result.survived = (tfc.isFleetAlive() && tfc.isInAsteroidField() == false);
+	result.shields = static_cast<int>(tfc.getShields());
+	result.asteroidsDestroyed = tfc.getNumAsteroidsDestroyed();
+	result.phaserProbesLaunched = tfc.getNumPhaserProbesLaunched();
+	result.time = clock.now();
+
+	return result;
+}
+
+// ================================================ //
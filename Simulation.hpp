@@ -0,0 +1,105 @@
+// ================================================ //
+// File: Simulation.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines Simulation class.
+// ================================================ //
+
+#ifndef __SIMULATION_HPP__
+#define __SIMULATION_HPP__
+
+// ================================================ //
+
+#include "TFC.hpp"
+#include "VirtualClock.hpp"
+
+class AsteroidField;
+
+// ================================================ //
+// Runs a whole asteroid field scenario in virtual time on the calling
+// thread. The TFC runs headless and probes are driven as discrete events:
+// each probe's next action is scheduled at the simulated time its delay
+// ends, and the clock jumps straight there, so a run takes milliseconds
+// rather than minutes and has no GUI. Runs with the same seed are
+// reproducible.
+class Simulation
+{
+public:
+	// Scenario options.
+	struct Config{
+		// Defensive probes launched alongside the scout.
+		Uint numPhotons;
+		Uint numPhasers;
+		// Asteroids per message (see Probe::BatchMax).
+		Uint batchSize;
+		// See AsteroidContainer::Type.
+		Uint containerType;
+		// Each probe's random number generator is seeded from this.
+		Uint seed;
+		// Simulated ms after which the run is abandoned.
+		Uint timeLimit;
+		// If not null, the scout reports this field at its recorded times
+		// instead of rolling asteroids (see Probe::stream()). Read only, so
+		// concurrent runs may share it.
+		const AsteroidField* field;
+
+		// Defaults to the GUI's starting fleet: one scout, two photon probes.
+		Config(void);
+	};
+
+	// Outcome of a run.
+	struct Result{
+		// True if the fleet made it through the asteroid field.
+		bool survived;
+		int shields;
+		Uint asteroidsDestroyed;
+		Uint asteroidsFound;
+		Uint collisions;
+		Uint probesLost;
+		Uint phaserProbesLaunched;
+		// Simulated time the run took (ms).
+		Uint time;
+		// Number of probe actions processed.
+		Uint events;
+	};
+
+	// Empty constructor.
+	explicit Simulation(const Config& config = Config());
+
+	// Empty destructor.
+	~Simulation(void);
+
+	// Runs the scenario to completion. May be called again for another run
+	// with the same options.
+	const Result run(void);
+
+	// Simulated ms a probe waiting on the TFC waits before checking again.
+	static const Uint PollInterval = 100;
+
+	// Time limit used by default, one simulated hour.
+	static const Uint DefaultTimeLimit = 3600000;
+
+private:
+	Config m_config;
+};
+
+// ================================================ //
+
+inline Simulation::Config::Config(void) :
+numPhotons(2),
+numPhasers(0),
+batchSize(1),
+containerType(AsteroidContainer::Type::PRIORITY),
+seed(1),
+timeLimit(Simulation::DefaultTimeLimit),
+field(nullptr)
+{
+
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -8,34 +8,120 @@
 
 #include "TFC.hpp"
 #include "Timer.hpp"
-#include "resource.h"
+#include "Reactor.hpp"
+#include "Channel.hpp"
+#include "ShmChannel.hpp"
+#include "LocalChannel.hpp"
+#include "LatencyHistogram.hpp"
+#include "Journal.hpp"
 
 // ================================================ //
 
 const std::string TFC::Port = "27876";
 
+std::atomic<TFC*> TFC::LocalServer(nullptr);
+
+// Held while ConnectLocal() uses LocalServer, so that TFC can't be
+// destroyed under it.
+static std::mutex LocalServerMutex;
+
+// ================================================ //
+
+struct TFC::ProbeTask{
+	ProbeTask(const ProbeRecord& record, const std::shared_ptr<Channel>& link) :
+	probe(record), channel(link), scheduled(false), done(false)
+	{
+
+	}
+
+	ProbeRecord probe;
+	// Released once done, breaking the cycle through its ready callback.
+	std::shared_ptr<Channel> channel;
+	// True while a run is queued or running; only that run may touch the
+	// channel.
+	std::atomic<bool> scheduled;
+	// Set once the probe has terminated or the fleet is gone.
+	std::atomic<bool> done;
+};
+
+// ================================================ //
+
+struct TFC::CallbackGate{
+	CallbackGate(void) : inside(0), closed(false)
+	{
+
+	}
+
+	// Returns false if the gate is closed; otherwise the caller may use
+	// the TFC until it calls leave().
+	bool enter(void){
+		// Announce the entry before checking closed, so close() either sees
+		// it and waits, or it sees closed and backs out.
+		inside.fetch_add(1);
+		if (closed){
+			inside.fetch_sub(1);
+			return false;
+		}
+		return true;
+	}
+
+	void leave(void){
+		inside.fetch_sub(1);
+	}
+
+	// Shuts out new callers and waits for those inside to leave.
+	void close(void){
+		closed = true;
+		while (inside != 0){
+			std::this_thread::yield();
+		}
+	}
+
+	std::atomic<Uint> inside;
+	std::atomic<bool> closed;
+};
+
 // ================================================ //
 
-TFC::TFC(void) :
-m_asteroids(),
-m_mutex(1), m_empty(15), m_full(0),
+TFC::TFC(const Config& config) :
+m_config(config),
+m_asteroids(config.containerType, config.capacity),
+m_mutex(1), m_empty(AsteroidContainer::MAX), m_full(0),
 m_probes(),
+m_probesMutex(),
+m_probeIDCtr(0),
 m_socket(INVALID_SOCKET),
-m_fleetAlive(true),
-m_inAsteroidField(false),
-m_shields(5),
-m_asteroidsDestroyed(0),
-m_pClock(new Timer()),
+m_shardSockets(),
+m_reactors(),
+m_pClock(new Timer(false, config.clock)),
 m_guiEvents(),
-m_scoutActive(false),
-m_numPhaserProbesLaunched(0)
+m_stats(),
+m_initError(0),
+m_stopping(false),
+m_threads(),
+m_finished(),
+m_channels(),
+m_threadsMutex(),
+m_gate(new CallbackGate()),
+m_tasks(),
+m_executorOnce(),
+m_executor()
 {
-	int ret = this->init();
-	if (ret != 0){
-		std::string str = "TFC failed to initialize server (Error: "
-			+ toString(ret) + ").";
-		MessageBox(GetForegroundWindow(), str.c_str(), "Error!", 
-				   MB_OK | MB_ICONERROR | MB_SETFOREGROUND);
+	m_stats.fleetAlive = true;
+	m_stats.inAsteroidField = false;
+	m_stats.scoutActive = false;
+
+	// In-process probes don't need the listener, so they can launch even
+	// if it fails. They are served on the executor, started by the first.
+	if (m_config.serverMode != TFC::ServerMode::HEADLESS){
+		TFC* expected = nullptr;
+		LocalServer.compare_exchange_strong(expected, this);
+	}
+
+	m_initError = this->init();
+	if (m_initError != 0){
+		fprintf(stderr, "TFC: failed to initialize server (Error: %d).\n", 
+				m_initError);
 	}
 }
 
@@ -43,12 +129,146 @@ m_numPhaserProbesLaunched(0)
 
 TFC::~TFC(void)
 {
+	{
+		std::lock_guard<std::mutex> lock(LocalServerMutex);
+		TFC* expected = this;
+		LocalServer.compare_exchange_strong(expected, nullptr);
+	}
+
+	// Wake every handler which may be blocked: on a channel, on the
+	// semaphores waiting for an asteroid, in accept() or in a reactor's
+	// wait for events. None start once m_stopping is set.
+	Uint blocked = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_threadsMutex);
+		m_stopping = true;
+		for (std::vector<std::shared_ptr<Channel>>::iterator itr = m_channels.begin();
+			 itr != m_channels.end(); ++itr){
+			(*itr)->interrupt();
+		}
+		blocked = static_cast<Uint>(m_threads.size());
+	}
+	if (blocked > 0){
+		m_full.signal(blocked);
+	}
+	for (std::vector<std::shared_ptr<Reactor>>::iterator itr = m_reactors.begin();
+		 itr != m_reactors.end(); ++itr){
+		(*itr)->stop();
+	}
+	if (m_config.serverMode == TFC::ServerMode::THREADED && m_socket != INVALID_SOCKET){
+#if defined(_WIN32)
+		// Only closing the listener wakes accept() here.
+		closesocket(m_socket);
+		m_socket = INVALID_SOCKET;
+#else
+		shutdown(m_socket, SD_BOTH);
+#endif
+	}
+
+	// Probe tasks: shut out their ready callbacks, which the probes' ends
+	// run, then close their channels and let queued runs finish.
+	m_gate->close();
+	{
+		std::lock_guard<std::mutex> lock(m_probesMutex);
+		for (std::vector<std::shared_ptr<ProbeTask>>::iterator itr = m_tasks.begin();
+			 itr != m_tasks.end(); ++itr){
+			(*itr)->done = true;
+			if ((*itr)->channel){
+				(*itr)->channel->interrupt();
+			}
+		}
+	}
+
+	// Join everything. A thread may still start another before it sees
+	// m_stopping, so keep going until none are left.
+	for (;;){
+		std::unordered_map<std::thread::id, std::thread> threads;
+		{
+			std::lock_guard<std::mutex> lock(m_threadsMutex);
+			threads.swap(m_threads);
+			m_finished.clear();
+		}
+		if (threads.empty()){
+			break;
+		}
+		for (std::unordered_map<std::thread::id, std::thread>::iterator itr =
+			 threads.begin(); itr != threads.end(); ++itr){
+			itr->second.join();
+		}
+	}
+	m_executor.reset();
+
+	// Only now, with no reactor left polling them, close the listeners.
 	closesocket(m_socket);
+	for (std::vector<SOCKET>::iterator itr = m_shardSockets.begin();
+		 itr != m_shardSockets.end(); ++itr){
+		closesocket(*itr);
+	}
 }
 
 // ================================================ //
 
 int TFC::init(void)
+{
+	if (m_config.serverMode == TFC::ServerMode::HEADLESS){
+		return 0;
+	}
+
+	// Each reactor gets its own listener where the kernel can spread
+	// incoming connections across them.
+	bool sharded = false;
+#if defined(SO_REUSEPORT)
+	sharded = (m_config.serverMode == TFC::ServerMode::REACTOR && 
+			   m_config.numReactors > 1);
+#endif
+
+	int i = this->openListener(m_socket, sharded);
+	if (i != 0){
+		return i;
+	}
+
+	if (m_config.serverMode == TFC::ServerMode::REACTOR){
+		Uint count = std::max<Uint>(1, m_config.numReactors);
+		Uint cores = std::max<Uint>(1, std::thread::hardware_concurrency());
+
+		// Open every shard's listener before starting any reactor, so a
+		// failure leaves none of them serving. Without SO_REUSEPORT every
+		// reactor polls the one listener and whichever wakes first takes
+		// the connection.
+		std::vector<SOCKET> listeners(count, m_socket);
+		for (Uint r = 1; sharded && r < count; ++r){
+			i = this->openListener(listeners[r], true);
+			if (i != 0){
+				for (std::vector<SOCKET>::iterator itr = m_shardSockets.begin();
+					 itr != m_shardSockets.end(); ++itr){
+					closesocket(*itr);
+				}
+				m_shardSockets.clear();
+				return i;
+			}
+			m_shardSockets.push_back(listeners[r]);
+		}
+
+		for (Uint r = 0; r < count; ++r){
+			// Spawn a thread to accept and serve probes, one per core. The
+			// destructor stops and joins it before closing its listener.
+			int core = (count > 1) ? static_cast<int>(r % cores) : -1;
+			std::shared_ptr<Reactor> reactor(new Reactor(this, listeners[r], core));
+			m_reactors.push_back(reactor);
+			this->startThread(std::bind(&Reactor::run, reactor));
+		}
+	}
+	else{
+		// Spawn a thread to accept new probe connections.
+		this->startThread(std::bind(&TFC::launchProbes, this));
+	}
+
+	return 0;
+}
+
+// ================================================ //
+
+int TFC::openListener(SOCKET& listener, const bool reusePort)
 {
 	struct addrinfo* result = nullptr;
 	struct addrinfo hints;
@@ -66,19 +286,39 @@ int TFC::init(void)
 	}
 
 	// Create a socket for server to listen for connections.
-	m_socket = socket(result->ai_family, 
+	listener = socket(result->ai_family, 
 					  result->ai_socktype, 
 					  result->ai_protocol);
-	if (m_socket == INVALID_SOCKET){
+	if (listener == INVALID_SOCKET){
 		freeaddrinfo(result);
-		return i;
+		return SOCKET_ERROR;
+	}
+
+#if !defined(_WIN32)
+	// Allow rebinding while connections from a previous run linger in
+	// TIME_WAIT. (On Windows this would let another process steal the port.)
+	{
+		int on = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, 
+				   reinterpret_cast<const char*>(&on), sizeof(on));
 	}
+#endif
+
+#if defined(SO_REUSEPORT)
+	// Allow several listeners on the same port, one per reactor.
+	if (reusePort){
+		int on = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, 
+				   reinterpret_cast<const char*>(&on), sizeof(on));
+	}
+#endif
 
 	// Bind the socket to network address.
-	i = bind(m_socket, result->ai_addr, static_cast<int>(result->ai_addrlen));
+	i = bind(listener, result->ai_addr, static_cast<int>(result->ai_addrlen));
 	if (i == SOCKET_ERROR){
 		freeaddrinfo(result);
-		closesocket(m_socket);
+		closesocket(listener);
+		listener = INVALID_SOCKET;
 		return i;
 	}
 
@@ -86,16 +326,12 @@ int TFC::init(void)
 	freeaddrinfo(result);
 
 	// Begin listening on socket for incoming connections.
-	if (listen(m_socket, SOMAXCONN) == SOCKET_ERROR){
-		closesocket(m_socket);
+	if (listen(listener, SOMAXCONN) == SOCKET_ERROR){
+		closesocket(listener);
+		listener = INVALID_SOCKET;
 		return SOCKET_ERROR;
 	}
 
-	// Spawn a thread to accept new probe connections.
-	std::thread t(&TFC::launchProbes, this);
-	// Allow continued execution of calling thread.
-	t.detach(); 
-
 	return 0;
 }
 
@@ -103,264 +339,763 @@ int TFC::init(void)
 
 void TFC::launchProbes(void)
 {
-	while (m_fleetAlive){
+	while (m_stats.fleetAlive && m_stopping == false){
 		// Accept incoming probe requests.
 		struct sockaddr_in probeInfo = { 0 };
-		int size = sizeof(probeInfo);
+		socklen_t size = sizeof(probeInfo);
 		SOCKET probeSocket = accept(m_socket, 
 									reinterpret_cast<struct sockaddr*>(&probeInfo), 
 									&size);
 		if (probeSocket == INVALID_SOCKET){
-			printf("TFC: accept() failed: %ld\n", WSAGetLastError());
+			if (m_stopping){
+				// The destructor shut the listener down.
+				break;
+			}
+			printf("TFC: accept() failed: %ld\n", static_cast<long>(WSAGetLastError()));
 			closesocket(probeSocket);
 			continue;
 		}
 
-		// Receive the request.
-		int r = 0;
-		Probe::Message msg;
-		r = recv(probeSocket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-		if (r > 0){
-			if (m_inAsteroidField == false){
-				if (msg.type == Probe::MessageType::LAUNCH_REQUEST){					
-					// Send a launch confirmation back to the probe, as well as the ID.
-					static Uint probeIDCtr = 0;
-					Probe::Message confirm;
-					confirm.type = Probe::MessageType::CONFIRM_LAUNCH;
-					confirm.id = probeIDCtr++;
-
-					int s = send(probeSocket, 
-								 reinterpret_cast<const char*>(&confirm), 
-								 sizeof(confirm), 
-								 0);
-					if (s > 0){
-						// Add probe to TFC list of probes.
-						ProbeRecord probe;
-						probe.socket = probeSocket;
-						probe.id = confirm.id;
-						probe.type = msg.LaunchRequest.type;
-						if (probe.type == Probe::Type::PHASER){
-							++m_numPhaserProbesLaunched;
-						}
-						m_probes.push_back(probe);
+		std::shared_ptr<Channel> channel(new SocketChannel(probeSocket));
+		this->acceptProbe(probeSocket, channel);
+	} // while(m_stats.fleetAlive)
+}
 
-						// Spawn a thread to handle the new probe.
-						std::thread t(&TFC::updateProbe, this, probe);
-						t.detach();
+// ================================================ //
+
+void TFC::acceptProbe(const SOCKET socket, std::shared_ptr<Channel> channel)
+{
+	if (this->track(channel) == false){
+		return;
+	}
+
+	// Receive the request.
+	Probe::Message msg;
+	if (channel->receive(msg)){
+		if (m_stats.inAsteroidField == false){
+			if (msg.type == Probe::MessageType::LAUNCH_REQUEST){					
+				// Send a launch confirmation back to the probe, as well as the ID.
+				Probe::Message confirm;
+				ProbeRecord probe = this->registerProbe(socket, 
+														msg.LaunchRequest.type, 
+														confirm);
+
+				// Move a probe on this host onto its shared memory rings
+				// if they can be attached; the socket then closes.
+				std::shared_ptr<Channel> probeChannel = channel;
+				if (msg.LaunchRequest.transport == Probe::Transport::SHARED_MEMORY){
+					msg.LaunchRequest.segment[Probe::SegmentNameMax - 1] = '\0';
+					std::shared_ptr<ShmChannel> shm(new ShmChannel());
+					if (shm->attach(msg.LaunchRequest.segment)){
+						confirm.LaunchRequest.transport = Probe::Transport::SHARED_MEMORY;
+						probeChannel = shm;
 					}
 				}
+
+				// A channel which announces its messages needs no thread
+				// waiting on it; the probe becomes a task on the executor.
+				// The callback must be in place before the probe hears back.
+				std::shared_ptr<ProbeTask> task(new ProbeTask(probe, probeChannel));
+				task->probe.mayBlock = false;
+				// The probe's end runs the callback, which may be after the
+				// TFC is gone, so it goes through the gate.
+				std::shared_ptr<CallbackGate> gate = m_gate;
+				if (probeChannel->setReadyCallback([this, gate, task](){
+					if (gate->enter()){
+						this->wakeTask(task);
+						gate->leave();
+					}
+				})){
+					std::call_once(m_executorOnce, [this](){
+						m_executor.reset(new ThreadPool());
+					});
+				}
+				else{
+					task.reset();
+				}
+
+				if (channel->send(confirm)){
+					if (task){
+						{
+							std::lock_guard<std::mutex> lock(m_probesMutex);
+							m_tasks.push_back(task);
+						}
+						this->wakeTask(task);
+					}
+					else{
+						// Spawn a thread to handle the new probe. The channel
+						// goes with it, along with anything already buffered.
+						this->startThread(std::bind(&TFC::updateProbe, this, 
+													probe, probeChannel));
+					}
+				}
+				else if (task){
+					// The callback holds the task, which holds the channel.
+					task->channel.reset();
+				}
 			}
-			// Don't allow new probe launches while navigating asteroid field.
-			else{
-				closesocket(probeSocket);
-			}
-		} // if (r > 0)
-	} // while(m_fleetAlive)
+		}
+		// Don't allow new probe launches while navigating asteroid field;
+		// the channel closes the socket.
+	}
+
+	this->untrack(channel);
 }
 
 // ================================================ //
 
-void TFC::updateProbe(const ProbeRecord& probe)
+Channel* TFC::ConnectLocal(void)
 {
-	bool probeAlive = true;
+	std::lock_guard<std::mutex> lock(LocalServerMutex);
+	TFC* tfc = LocalServer.load();
+	if (tfc == nullptr){
+		return nullptr;
+	}
+
+	std::unique_ptr<LocalChannel> probeEnd, tfcEnd;
+	LocalChannel::CreatePair(probeEnd, tfcEnd);
+
+	// The probe sends its launch request as soon as this returns.
+	std::shared_ptr<Channel> channel(tfcEnd.release());
+	if (tfc->startThread(std::bind(&TFC::acceptProbe, tfc, INVALID_SOCKET, 
+								   channel)) == false){
+		return nullptr;
+	}
+
+	return probeEnd.release();
+}
+
+// ================================================ //
 
-	while (m_fleetAlive && probeAlive){
+void TFC::updateProbe(const ProbeRecord& probe, std::shared_ptr<Channel> channel)
+{
+	bool probeAlive = this->track(channel);
+	std::vector<Probe::Message> replies;
+
+	while (m_stats.fleetAlive && probeAlive && m_stopping == false){
 		// Receive the request.
-		if (m_inAsteroidField){
+		if (m_stats.inAsteroidField){
 			// Only allow the scout probe to check destruction conditions.
 			// This prevents possible race conditions in this step.
 			if (probe.type == Probe::Type::SCOUT){
-				// First, activate the scout probe if this is the first iteration.
-				if (m_scoutActive == false){
-					Probe::Message activate;
-					activate.type = Probe::MessageType::SCOUT_REQUEST;
-					int s = send(probe.socket, 
-								 reinterpret_cast<const char*>(&activate), 
-								 sizeof(activate), 
-								 0);
-					if (s > 0){
-						m_scoutActive = true;
-					}
+				this->updateFieldStatus(replies);
+				channel->send(replies);
+				replies.clear();
+			}
+
+			// Read the message in place, then hand its buffer back.
+			const Probe::Message* msg = channel->take();
+			if (msg != nullptr){
+				probeAlive = this->handleMessage(probe, *msg, replies);
+				int type = msg->type;
+				channel->release(msg);
+				if (replies.empty() == false){
+					int64_t start = Telemetry::Now();
+					channel->send(replies);
+					Telemetry::Record(probe.type, type, Telemetry::NETWORK,
+									  Telemetry::Now() - start);
+					replies.clear();
 				}
+			}
+			else{
+				// Connection lost or sent garbage.
+				probeAlive = false;
+			}
+		}
+		// If not in asteroid field.
+		else{
+			// Wait for TFC to engage asteroid field.
+			Timer::Delay(100);
+		}		
+	}
+
+	this->untrack(channel);
+	channel->disconnect();
+}
+
+// ================================================ //
+
+void TFC::enterAsteroidField(void)
+{
+	m_stats.inAsteroidField = true;
+	m_pClock->restart();
+	if (m_config.journal != nullptr){
+		m_config.journal->append(Journal::RecordType::FIELD_ENTERED, 0, 0, 0);
+	}
+
+	// Start the scout's task, which activates it, and serve anything held.
+	std::lock_guard<std::mutex> lock(m_probesMutex);
+	for (std::vector<std::shared_ptr<ProbeTask>>::iterator itr = m_tasks.begin();
+		 itr != m_tasks.end(); ++itr){
+		this->wakeTask(*itr);
+	}
+}
+
+// ================================================ //
+
+void TFC::wakeTask(const std::shared_ptr<ProbeTask>& task)
+{
+	if (task->done == false && task->scheduled.exchange(true) == false){
+		m_executor->submit(std::bind(&TFC::runTask, this, task));
+	}
+}
+
+// ================================================ //
+
+void TFC::runTask(std::shared_ptr<ProbeTask> task)
+{
+	if (task->done){
+		return;
+	}
+
+	bool probeAlive = true;
+	Uint handled = 0;
+	std::vector<Probe::Message> replies;
+
+	// As in updateProbe(), nothing is read until the TFC engages the
+	// asteroid field; enterAsteroidField() wakes every task then.
+	while (m_stats.fleetAlive && probeAlive && m_stats.inAsteroidField){
+		// Only allow the scout probe to check destruction conditions.
+		if (task->probe.type == Probe::Type::SCOUT){
+			this->updateFieldStatus(replies);
+			task->channel->send(replies);
+			replies.clear();
+		}
+
+		if (handled == TFC::TaskBudget || task->channel->poll() == false){
+			break;
+		}
+
+		// A message is waiting, so this doesn't block.
+		const Probe::Message* msg = task->channel->take();
+		if (msg != nullptr){
+			probeAlive = this->handleMessage(task->probe, *msg, replies);
+			int type = msg->type;
+			task->channel->release(msg);
+			if (replies.empty() == false){
+				int64_t start = Telemetry::Now();
+				task->channel->send(replies);
+				Telemetry::Record(task->probe.type, type, Telemetry::NETWORK,
+								  Telemetry::Now() - start);
+				replies.clear();
+			}
+			++handled;
+		}
+		else{
+			// Channel closed.
+			probeAlive = false;
+		}
+	}
+
+	if (m_stats.fleetAlive == false || probeAlive == false){
+		task->done = true;
+		task->channel->disconnect();
 
-				// If shields are gone, trigger fleet destruction.
-				if (m_shields <= 0){
-					m_fleetAlive = m_inAsteroidField = false;
-					// Force all probe threads to close.
-					GUIEvent e;
-					e.type = GUIEventType::FLEET_DESTROYED;
-					m_guiEvents.push(e);
+		// Released under the lock, as the destructor may be interrupting it.
+		std::lock_guard<std::mutex> lock(m_probesMutex);
+		task->channel.reset();
+		m_tasks.erase(std::remove(m_tasks.begin(), m_tasks.end(), task), m_tasks.end());
+		return;
+	}
+
+	if (handled == TFC::TaskBudget){
+		// Still scheduled; go to the back of the line.
+		m_executor->submit(std::bind(&TFC::runTask, this, task));
+		return;
+	}
+
+	// Release the task, then look again in case a message arrived before
+	// its sender could see it was released.
+	task->scheduled = false;
+	if (m_stats.inAsteroidField && task->channel->poll() &&
+		task->scheduled.exchange(true) == false){
+		m_executor->submit(std::bind(&TFC::runTask, this, task));
+	}
+}
+
+// ================================================ //
+
+bool TFC::startThread(const std::function<void(void)>& f)
+{
+	std::lock_guard<std::mutex> lock(m_threadsMutex);
+	if (m_stopping){
+		return false;
+	}
+
+	// Reap the threads which have returned since the last start.
+	for (std::vector<std::thread::id>::iterator itr = m_finished.begin();
+		 itr != m_finished.end(); ++itr){
+		std::unordered_map<std::thread::id, std::thread>::iterator t = 
+			m_threads.find(*itr);
+		if (t != m_threads.end()){
+			t->second.join();
+			m_threads.erase(t);
+		}
+	}
+	m_finished.clear();
+
+	std::thread t([this, f](){
+		f();
+		std::lock_guard<std::mutex> lock(m_threadsMutex);
+		m_finished.push_back(std::this_thread::get_id());
+	});
+	std::thread::id id = t.get_id();
+	m_threads[id] = std::move(t);
+
+	return true;
+}
+
+// ================================================ //
+
+bool TFC::track(const std::shared_ptr<Channel>& channel)
+{
+	std::lock_guard<std::mutex> lock(m_threadsMutex);
+	if (m_stopping){
+		return false;
+	}
+
+	m_channels.push_back(channel);
+	return true;
+}
+
+// ================================================ //
+
+void TFC::untrack(const std::shared_ptr<Channel>& channel)
+{
+	std::lock_guard<std::mutex> lock(m_threadsMutex);
+	std::vector<std::shared_ptr<Channel>>::iterator itr = 
+		std::find(m_channels.begin(), m_channels.end(), channel);
+	if (itr != m_channels.end()){
+		m_channels.erase(itr);
+	}
+}
+
+// ================================================ //
+
+const ProbeRecord TFC::registerProbe(const SOCKET socket, const Uint type, 
+									 Probe::Message& confirm)
+{
+	ZeroMemory(&confirm, sizeof(confirm));
+	confirm.type = Probe::MessageType::CONFIRM_LAUNCH;
+	confirm.id = m_probeIDCtr++;
+
+	// Add probe to TFC list of probes.
+	ProbeRecord probe;
+	probe.socket = socket;
+	probe.id = confirm.id;
+	probe.type = type;
+	probe.mayBlock = (m_config.serverMode == TFC::ServerMode::THREADED);
+	if (probe.type == Probe::Type::PHASER){
+		m_stats.phaserProbesLaunched.add();
+	}
+
+	if (m_config.journal != nullptr){
+		m_config.journal->append(Journal::RecordType::LAUNCH, probe.id, probe.type,
+								 m_pClock->getTicks());
+	}
+
+	std::lock_guard<std::mutex> lock(m_probesMutex);
+	m_probes.push_back(probe);
+
+	return probe;
+}
+
+// ================================================ //
+
+void TFC::updateFieldStatus(std::vector<Probe::Message>& replies)
+{
+	// First, activate the scout probe if this is the first iteration.
+	if (m_stats.scoutActive.exchange(true) == false){
+		Probe::Message activate;
+		ZeroMemory(&activate, sizeof(activate));
+		activate.type = Probe::MessageType::SCOUT_REQUEST;
+		replies.push_back(activate);
+	}
+
+	// Leaving the field is decided exactly once, by whoever clears the flag.
+	// If shields are gone, trigger fleet destruction.
+	if (this->getShields() == 0){
+		if (m_stats.inAsteroidField.exchange(false)){
+			// Force all probe threads to close.
+			m_stats.fleetAlive = false;
+			if (m_config.journal != nullptr){
+				m_config.journal->append(Journal::RecordType::FLEET_DESTROYED, 0, 
+										 Probe::Type::SCOUT, m_pClock->getTicks());
+			}
+			GUIEvent e;
+			e.type = GUIEventType::FLEET_DESTROYED;
+			m_guiEvents.push(e);
+		}
+	}
+	else if (this->getNumAsteroidsDestroyed() > 55){
+		if (m_stats.inAsteroidField.exchange(false)){
+			if (m_config.journal != nullptr){
+				m_config.journal->append(Journal::RecordType::FLEET_SURVIVED, 0, 
+										 Probe::Type::SCOUT, m_pClock->getTicks());
+			}
+			GUIEvent e;
+			e.type = GUIEventType::FLEET_SURVIVED;
+			m_guiEvents.push(e);
+		}
+	}
+}
+
+// ================================================ //
+
+const bool TFC::handleMessage(const ProbeRecord& probe, const Probe::Message& msg,
+							  std::vector<Probe::Message>& replies)
+{
+	int64_t start = Telemetry::Now();
+	// Time blocked on the asteroid container's semaphores, if touched.
+	int64_t waited = -1;
+	bool probeAlive = true;
+
+	// Messages about asteroids are journaled once the container is held.
+	if (msg.type != Probe::MessageType::ASTEROID_FOUND &&
+		msg.type != Probe::MessageType::ASTEROIDS_FOUND &&
+		msg.type != Probe::MessageType::DEFENSIVE_REQUEST &&
+		msg.type != Probe::MessageType::DEFENSIVE_BATCH_REQUEST){
+		this->journal(Journal::RecordType::MESSAGE, probe, &msg);
+	}
+
+	switch (msg.type){
+	default:
+		break;
+
+	case Probe::MessageType::LAUNCH_REQUEST:
+		// Only accept launch requests while not in asteroid field.
+		break;
+
+	case Probe::MessageType::SCOUT_REQUEST:
+		{
+			Probe::Message response;
+			// Ack request.
+			response.type = Probe::MessageType::SCOUT_REQUEST;
+			response.time = m_pClock->getTicks();
+			replies.push_back(response);
+		}
+		break;
+
+	case Probe::MessageType::ASTEROID_FOUND:
+		waited = this->insertAsteroids(probe, &msg, &msg.asteroid, 1);
+		break;
+
+	case Probe::MessageType::ASTEROIDS_FOUND:
+		waited = this->insertAsteroids(probe, &msg, msg.Batch.asteroids, 
+							  std::min<Uint>(msg.Batch.count, Probe::BatchMax));
+		break;
+
+	case Probe::MessageType::DEFENSIVE_REQUEST:
+		{
+			Probe::Message response;
+			waited = this->takeTargets(probe, msg, 1, response);
+			if (response.type == Probe::MessageType::TARGETS_AVAILABLE){
+				// Answer in the single target form.
+				Asteroid a = response.Batch.asteroids[0];
+				response.type = Probe::MessageType::TARGET_AVAILABLE;
+				response.asteroid = a;
+			}
+
+			// Send the requested data to the probe.
+			replies.push_back(response);
+		}
+		break;
+
+	case Probe::MessageType::DEFENSIVE_BATCH_REQUEST:
+		{
+			Probe::Message response;
+			waited = this->takeTargets(probe, msg, msg.Batch.count, response);
+			replies.push_back(response);
+		}
+		break;
+
+	case Probe::MessageType::TARGET_DESTROYED:					
+		{
+			m_stats.asteroidsDestroyed.add();
+			GUIEvent e;
+			e.type = GUIEventType::ASTEROID_DESTROYED;
+			e.id = probe.id;
+			e.x = msg.asteroid.id;
+			m_guiEvents.push(e);
+		}
+		break;
+
+	case Probe::MessageType::TERMINATED:
+		{						
+			m_stats.asteroidsDestroyed.add();
+			// Trigger GUI event to remove probe.
+			GUIEvent e;
+			e.type = GUIEventType::PROBE_TERMINATED;
+			e.id = probe.id;
+			e.x = msg.asteroid.id;
+			m_guiEvents.push(e);
+			probeAlive = false;
+
+			// Probe destroyed, remove from probe list.
+			std::lock_guard<std::mutex> lock(m_probesMutex);
+			for (std::vector<ProbeRecord>::iterator itr = m_probes.begin();
+				 itr != m_probes.end();){
+				if (itr->id == probe.id){
+					itr = m_probes.erase(itr);
+					break;
 				}
-				else if (m_asteroidsDestroyed > 55){
-					m_inAsteroidField = false;
-					GUIEvent e;
-					e.type = GUIEventType::FLEET_SURVIVED;
-					m_guiEvents.push(e);
+				else{
+					++itr;
 				}
 			}
+		}
+		break;
+	}
 
-			int r = 0;
-			Probe::Message msg;
-			r = recv(probe.socket, reinterpret_cast<char*>(&msg), sizeof(msg), 0);
-			if (r > 0){
-				switch (msg.type){
-				default:
-					break;
+	int64_t elapsed = Telemetry::Now() - start;
+	if (waited >= 0){
+		Telemetry::Record(probe.type, msg.type, Telemetry::SEMAPHORE_WAIT, waited);
+		elapsed -= waited;
+	}
+	Telemetry::Record(probe.type, msg.type, Telemetry::SERVICE, elapsed);
 
-				case Probe::MessageType::LAUNCH_REQUEST:
-					// Only accept launch requests while not in asteroid field.
-					break;
+	return probeAlive;
+}
 
-				case Probe::MessageType::SCOUT_REQUEST:
-					{
-						Probe::Message response;
-						// Ack request.
-						response.type = Probe::MessageType::SCOUT_REQUEST;
-						response.time = m_pClock->getTicks();
-						int s = send(probe.socket, 
-									 reinterpret_cast<const char*>(&response), 
-									 sizeof(response), 
-									 0);
-					}
-					break;
+// ================================================ //
 
-				case Probe::MessageType::ASTEROID_FOUND:
-					if (m_asteroids.full()){
-						--m_shields;
-						++m_asteroidsDestroyed;
-						GUIEvent e;
-						e.type = GUIEventType::ASTEROID_COLLISION;
-						e.id = msg.asteroid.id;
-						m_guiEvents.push(e);						
-					}					
-					else{			
-						// Producer:
-						// Wait for synchronized access to asteroid array.
-						m_empty.wait();
-						m_mutex.wait();
-
-						if (m_asteroids.insert(msg.asteroid))
-						{
-							// Inform main GUI of new asteroid.
-							GUIEvent e;
-							e.type = GUIEventType::ASTEROID_FOUND;
-							e.asteroid = msg.asteroid;
-							m_guiEvents.push(e);
-						}
+const int64_t TFC::insertAsteroids(const ProbeRecord& probe, const Probe::Message* request,
+								   const Asteroid* asteroids, const Uint count)
+{
+	int64_t waited = -1;
+	Uint inserted = 0;
+	if (m_asteroids.isConcurrent()){
+		// Lock-free container, no need to wait on semaphores.
+		inserted = m_asteroids.insert(asteroids, count);
+		this->journalAsteroids(probe, request, asteroids + inserted, count - inserted);
+	}
+	else{
+		// Producer:
+		// Claim a free slot for each asteroid; any without one will
+		// collide with the fleet.
+		Uint slots = 0;
+		while (slots < count && m_empty.tryWait()){
+			++slots;
+		}
 
-						// Allow next person in.
-						m_mutex.signal();
-						m_full.signal();
-					}
-					break;
+		waited = 0;
+		if (slots > 0){
+			// Wait for synchronized access to asteroid array, once for the
+			// whole batch.
+			int64_t start = Telemetry::Now();
+			m_mutex.wait();
+			waited = Telemetry::Now() - start;
+			inserted = m_asteroids.insert(asteroids, slots);
+			this->journalAsteroids(probe, request, asteroids + inserted, count - inserted);
+			// Allow next person in.
+			m_mutex.signal();
+
+			if (inserted > 0){
+				m_full.signal(inserted);
+			}
+			if (inserted < slots){
+				m_empty.signal(slots - inserted);
+			}
+		}
+		else{
+			// No room for any; the container is untouched.
+			this->journalAsteroids(probe, request, asteroids, count);
+		}
+	}
 
-				case Probe::MessageType::DEFENSIVE_REQUEST:
-					{
-						// Consumer:
-						// Wait turn, prevent race conditions.							
-						m_full.wait();
-						m_mutex.wait();
+	for (Uint i = 0; i < count; ++i){
+		GUIEvent e;
+		if (i < inserted){
+			// Inform main GUI of new asteroid.
+			e.type = GUIEventType::ASTEROID_FOUND;
+			e.asteroid = asteroids[i];
+		}
+		else{
+			m_stats.shieldHits.add();
+			m_stats.asteroidsDestroyed.add();
+			e.type = GUIEventType::ASTEROID_COLLISION;
+			e.id = asteroids[i].id;
+		}
+		m_guiEvents.push(e);
+	}
 
-						Probe::Message response;
-						if (m_asteroids.empty()){
-							response.type = Probe::MessageType::NO_TARGET;
-						}
-						else{
-							bool asteroidFound = false;
-							Asteroid a;
-							// Keep retrieving the next asteroid until a valid
-							// one is found.
-							ZeroMemory(&a, sizeof(a));
-							while (asteroidFound == false && m_asteroids.empty() == false){
-								// Acquire next asteroid.
-								a = m_asteroids.remove();
-
-								Uint time = m_pClock->getTicks();
-								// See if there is time to destroy next asteroid.
-								// [if (current time < time found + time to collision)]
-								if (time < a.impactTime){
-									// Send asteroid info to probe.
-									response.asteroid = a;
-									response.type = Probe::MessageType::TARGET_AVAILABLE;
-									response.time = time;
-									asteroidFound = true;
-								}
-								else{
-									// Take hit on shields and report to GUI.
-									--m_shields;
-									++m_asteroidsDestroyed;
-									GUIEvent e;
-									e.type = GUIEventType::ASTEROID_COLLISION;
-									e.id = a.id;
-									m_guiEvents.push(e);									
-								}
-
-								// Trigger GUI event to remove asteroid from listview.
-								GUIEvent e;
-								e.type = GUIEventType::ASTEROID_REMOVED;
-								e.x = a.id;
-								m_guiEvents.push(e);
-							}
-						}
+	return waited;
+}
 
-						// Allow other probes to access asteroid buffer.
-						m_mutex.signal();
-						m_empty.signal();
+// ================================================ //
 
-						// Send the requested data to the probe.
-						int s = send(probe.socket, 
-									 reinterpret_cast<const char*>(&response), 
-									 sizeof(response), 
-									 0);
-					}
-					break;
+const int64_t TFC::takeTargets(const ProbeRecord& probe, const Probe::Message& request,
+							   const Uint max, Probe::Message& response)
+{
+	int64_t waited = -1;
+	Uint limit = std::min<Uint>(std::max<Uint>(max, 1), Probe::BatchMax);
 
-				case Probe::MessageType::TARGET_DESTROYED:					
-					{
-						++m_asteroidsDestroyed;
-						GUIEvent e;
-						e.type = GUIEventType::ASTEROID_DESTROYED;
-						e.id = probe.id;
-						e.x = msg.id;
-						m_guiEvents.push(e);
-					}
-					break;
+	ZeroMemory(&response, sizeof(response));
+	// Reported if nothing valid is left (possible with the lock-free
+	// container, which is not gated on m_full).
+	response.type = Probe::MessageType::NO_TARGET;
 
-				case Probe::MessageType::TERMINATED:
-					{						
-						++m_asteroidsDestroyed;
-						// Trigger GUI event to remove probe.
-						GUIEvent e;
-						e.type = GUIEventType::PROBE_TERMINATED;
-						e.id = probe.id;
-						e.x = msg.id;
-						m_guiEvents.push(e);
-						probeAlive = false;
-
-						// Probe destroyed, remove from probe list.		
-						for (std::vector<ProbeRecord>::iterator itr = m_probes.begin();
-							 itr != m_probes.end();){
-							if (itr->id == probe.id){
-								itr = m_probes.erase(itr);
-								break;
-							}
-							else{
-								++itr;
-							}
-						}
-					}
-					break;
+	// Consumer:
+	// Wait turn, prevent race conditions. A reactor or the executor serves
+	// many probes on one thread, so it answers NO_TARGET rather than block
+	// until an asteroid shows up.
+	if (m_asteroids.isConcurrent() == false){
+		int64_t start = Telemetry::Now();
+		if (probe.mayBlock){
+			m_full.wait();
+			if (m_stopping){
+				// Woken by the destructor rather than an asteroid.
+				return Telemetry::Now() - start;
+			}
+		}
+		else if (m_full.tryWait() == false){
+			this->journal(Journal::RecordType::MESSAGE, probe, &request);
+			this->journal(Journal::RecordType::TARGETS, probe, &response);
+			return Telemetry::Now() - start;
+		}
+		m_mutex.wait();
+		waited = Telemetry::Now() - start;
+	}
+
+	// Pull every asteroid that has already reached the fleet out in one
+	// call rather than popping them one at a time.
+	Uint time = m_pClock->getTicks();
+	std::vector<Asteroid> expired;
+	Uint removed = m_asteroids.drainExpired(time, expired);
+
+	// Keep retrieving the next asteroid until enough valid ones are found.
+	// ready tracks when the probe's weapon is free, as the probe itself
+	// will work through the batch.
+	Uint count = 0;
+	Uint ready = time;
+	Uint recharge = Probe::WeaponRechargeTime(probe.type);
+	// Out of reach target which could not be put straight back.
+	bool deferred = false;
+	Asteroid leftover;
+	ZeroMemory(&leftover, sizeof(leftover));
+	Asteroid a;
+	ZeroMemory(&a, sizeof(a));
+	while (count < limit && m_asteroids.tryRemove(a)){
+		time = m_pClock->getTicks();
+		// See if there is time to destroy next asteroid.
+		// [if (current time < time found + time to collision)]
+		if (time < a.impactTime){
+			Uint kill = Probe::KillTime(probe.type, a.mass);
+			ready = std::max(ready, time);
+			if (count > 0 && ready + kill >= a.impactTime){
+				// Out of this probe's reach; put it back for another. A
+				// concurrent container may have been filled since it was
+				// taken, so failing that, hold it until the container is
+				// released and insert it as a new discovery.
+				if (m_asteroids.insert(a) == false){
+					++removed;
+					leftover = a;
+					deferred = true;
 				}
+				break;
 			}
+
+			++removed;
+			ready += kill + recharge;
+			response.Batch.asteroids[count++] = a;
+
+			// Trigger GUI event to remove asteroid from listview.
+			GUIEvent e;
+			e.type = GUIEventType::ASTEROID_REMOVED;
+			e.x = a.id;
+			m_guiEvents.push(e);
 		}
-		// If not in asteroid field.
 		else{
-			// Wait for TFC to engage asteroid field.
-			Timer::Delay(100);
-		}		
+			++removed;
+			expired.push_back(a);
+		}
 	}
 
-	closesocket(probe.socket);
+	if (count > 0){
+		// Send asteroid info to probe.
+		response.type = Probe::MessageType::TARGETS_AVAILABLE;
+		response.time = time;
+		response.Batch.count = count;
+	}
+
+	// Record the decision while the container is still held, so it is
+	// journaled in order. (The lock-free container has no such order.)
+	if (m_config.journal != nullptr){
+		this->journalAsteroids(probe, &request, expired.data(), 
+							   static_cast<Uint>(expired.size()));
+		this->journal(Journal::RecordType::TARGETS, probe, &response);
+	}
+
+	// Allow other probes to access asteroid buffer, freeing one slot per
+	// asteroid taken out. Only one m_full was waited on above, so take
+	// the rest without blocking to keep it equal to the number held. That
+	// must happen while the container is still held; afterwards a token
+	// could belong to an asteroid inserted since, and taking it would
+	// leave a waiting defender asleep beside it.
+	if (m_asteroids.isConcurrent() == false){
+		for (Uint i = 1; i < removed; ++i){
+			m_full.tryWait();
+		}
+		m_mutex.signal();
+		if (removed > 0){
+			m_empty.signal(removed);
+		}
+	}
+
+	for (std::vector<Asteroid>::iterator itr = expired.begin();
+		 itr != expired.end(); ++itr){
+		// Take hit on shields and report to GUI.
+		m_stats.shieldHits.add();
+		m_stats.asteroidsDestroyed.add();
+		GUIEvent e;
+		e.type = GUIEventType::ASTEROID_COLLISION;
+		e.id = itr->id;
+		m_guiEvents.push(e);
+
+		e.type = GUIEventType::ASTEROID_REMOVED;
+		e.x = itr->id;
+		m_guiEvents.push(e);
+	}
+
+	if (deferred){
+		GUIEvent e;
+		e.type = GUIEventType::ASTEROID_REMOVED;
+		e.x = leftover.id;
+		m_guiEvents.push(e);
+		this->insertAsteroids(probe, nullptr, &leftover, 1);
+	}
+
+	return waited;
+}
+
+// ================================================ //
+
+void TFC::journal(const Uint type, const ProbeRecord& probe, const Probe::Message* msg)
+{
+	if (m_config.journal != nullptr){
+		m_config.journal->append(type, probe.id, probe.type, m_pClock->getTicks(), msg);
+	}
+}
+
+// ================================================ //
+
+void TFC::journalAsteroids(const ProbeRecord& probe, const Probe::Message* request,
+						   const Asteroid* collided, const Uint count)
+{
+	if (m_config.journal == nullptr){
+		return;
+	}
+
+	if (request != nullptr){
+		this->journal(Journal::RecordType::MESSAGE, probe, request);
+	}
+
+	Probe::Message msg;
+	ZeroMemory(&msg, sizeof(msg));
+	for (Uint i = 0; i < count; ++i){
+		msg.asteroid = collided[i];
+		this->journal(Journal::RecordType::COLLISION, probe, &msg);
+	}
 }
 
 // ================================================ //
\ No newline at end of file
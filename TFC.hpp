@@ -15,6 +15,14 @@
 #include "Probe.hpp"
 #include "Timer.hpp"
 #include "Semaphore.hpp"
+#include "MPSCQueue.hpp"
+#include "ShardedCounter.hpp"
+#include "ThreadPool.hpp"
+#include <unordered_map>
+
+class Reactor;
+class Channel;
+class Journal;
 
 // ================================================ //
 
@@ -23,15 +31,20 @@ struct ProbeRecord{
 	SOCKET socket;
 	Uint id;
 	Uint type;
+	// True if the probe's handler has a thread of its own, so it may wait
+	// on the semaphores for an asteroid rather than answer NO_TARGET.
+	bool mayBlock;
 };
 
 // Any event to be processed by the GUI update thread.
 struct GUIEvent{
 	Uint type;
-	int id;
+	// Asteroid ID, or probe ID for ASTEROID_DESTROYED and PROBE_TERMINATED.
+	uint64_t id;
 	union{
 		Asteroid asteroid;
-		int x;
+		// Asteroid ID where id is the probe's, and for ASTEROID_REMOVED.
+		uint64_t x;
 	};
 };
 
@@ -51,27 +64,100 @@ enum GUIEventType{
 class TFC
 {
 public:
+	// How probe connections are served.
+	enum ServerMode{
+		// One blocking thread per probe.
+		THREADED = 0,
+		// All probe sockets multiplexed on one non-blocking event loop.
+		REACTOR,
+		// No sockets at all; a driver such as Simulation calls
+		// registerProbe() and handleMessage() directly.
+		HEADLESS
+	};
+
+	// Construction options.
+	struct Config{
+		// AsteroidContainer backing (see AsteroidContainer::Type). The
+		// semaphores are bypassed when the container is concurrent.
+		Uint containerType;
+		// Capacity of the concurrent container backings.
+		Uint capacity;
+		// See TFC::ServerMode.
+		Uint serverMode;
+		// Number of reactor threads in ServerMode::REACTOR. Each is pinned
+		// to a core and, where SO_REUSEPORT exists, accepts on its own
+		// listener, so launches are spread across them.
+		Uint numReactors;
+		// If not null, the TFC's clock reads this simulated time instead of
+		// the wall clock.
+		VirtualClock* clock;
+		// If not null, every launch, handled message and decision about the
+		// asteroids is appended here for replaying (see Replay). Must
+		// outlive the TFC's handlers.
+		Journal* journal;
+
+		// Defaults to the original threaded, semaphore-guarded server.
+		Config(void);
+	};
+
 	// Initializes member variables and calls init().
-	explicit TFC(void);
+	explicit TFC(const Config& config = Config());
 
-	// Closes socket.
+	// Stops the reactors, the accept thread, every probe handler and the
+	// executor, waits for them all, then closes the sockets. Probes still
+	// connected see their channels close.
 	~TFC(void);
 
 	// Sets up server socket, binds and begins listening.
 	// Returns zero on success, otherwise the error code is returned.
 	int init(void);
 
-	// Sets the local flag m_inAsteroidField to true.
+	// Creates a socket bound to TFC::Port and listening, optionally with
+	// SO_REUSEPORT so several can share the port. Returns zero on success,
+	// otherwise the error code is returned.
+	int openListener(SOCKET& listener, const bool reusePort);
+
+	// Sets the flag m_stats.inAsteroidField to true and wakes the probe
+	// tasks, whose requests are held until then.
 	void enterAsteroidField(void);
 
 	// Accept launch requests from probes and process them.
 	void launchProbes(void);
 
-	// Process requests from a single probe.
-	void updateProbe(const ProbeRecord& probe);
+	// Receives the launch request from a newly connected probe and, if it
+	// may launch, confirms it and serves it: as a task on the executor if
+	// its channel can announce messages, otherwise on a thread of its own.
+	void acceptProbe(const SOCKET socket, std::shared_ptr<Channel> channel);
+
+	// Connects to the TFC in this process over a LocalChannel, serving the
+	// launch request on a new thread. Returns the probe's end, owned by the
+	// caller, or nullptr if there is no TFC serving probes in this process.
+	static Channel* ConnectLocal(void);
+
+	// Process requests from a single probe over its channel.
+	void updateProbe(const ProbeRecord& probe, std::shared_ptr<Channel> channel);
+
+	// Assigns an ID to a newly connected probe of the given type and adds it
+	// to the list of probes. Fills confirm with the CONFIRM_LAUNCH reply.
+	const ProbeRecord registerProbe(const SOCKET socket, const Uint type,
+									Probe::Message& confirm);
+
+	// Processes one message from a probe, appending any responses to
+	// replies. Returns false if the probe has terminated.
+	const bool handleMessage(const ProbeRecord& probe, const Probe::Message& msg,
+							 std::vector<Probe::Message>& replies);
+
+	// Called on behalf of the scout: activates it on entering the asteroid
+	// field (appending the request to replies) and decides whether the
+	// fleet has been destroyed or has made it through.
+	void updateFieldStatus(std::vector<Probe::Message>& replies);
 
 	// Getters
 
+	// Returns the error code from init() during construction, zero if the
+	// server started.
+	const int getInitError(void) const;
+
 	// Returns number of probes launched.
 	const int getNumProbes(void) const;
 
@@ -81,6 +167,13 @@ public:
 	// Returns next GUIEvent in queue or nullptr if empty.
 	const GUIEvent getNextGUIEvent(void);
 
+	// Waits up to ms milliseconds for the next GUIEvent. Returns false if
+	// none arrived.
+	bool waitGUIEvent(GUIEvent& e, const Uint ms);
+
+	// Appends every pending GUIEvent to events. Returns number appended.
+	const Uint drainGUIEvents(std::vector<GUIEvent>& events);
+
 	// Returns true if there are GUI events in the queue.
 	const bool hasGUIEvent(void) const;
 
@@ -96,6 +189,9 @@ public:
 	// Returns true if fleet is currently in asteroid field.
 	const bool isInAsteroidField(void) const;
 
+	// Returns false once the fleet has been destroyed.
+	const bool isFleetAlive(void) const;
+
 	// Returns number of phaser probes launched before navigating field.
 	const Uint getNumPhaserProbesLaunched(void) const;
 
@@ -104,32 +200,149 @@ public:
 	// Port the TFC listens on.
 	static const std::string Port;
 
+	// Shield level on entering the asteroid field.
+	static const int Shields = 5;
+
+	// The first TFC constructed with a server, which ConnectLocal() uses.
+	static std::atomic<TFC*> LocalServer;
+
 private:
+	// Inserts asteroids reported by probe under one acquisition of the
+	// container. Any that don't fit collide with the fleet. The request
+	// that reported them, if not null, is journaled while the container is
+	// held, followed by the collisions. Returns nanoseconds spent waiting
+	// on the semaphores, or -1 if the container is concurrent and they were
+	// bypassed.
+	const int64_t insertAsteroids(const ProbeRecord& probe, const Probe::Message* request,
+								  const Asteroid* asteroids, const Uint count);
+
+	// Removes up to max targets (at most Probe::BatchMax) for probe's
+	// request under one acquisition of the container, reporting any that
+	// have already hit the fleet. After the first target, each is only
+	// assigned if the probe's weapon can destroy it in time behind the ones
+	// before it (see Probe::KillTime()); otherwise it is left for another
+	// defender and the batch ends. Fills response with TARGETS_AVAILABLE or
+	// NO_TARGET; if the probe may not block it answers NO_TARGET rather than
+	// wait for an asteroid. The request, collisions and response are
+	// journaled while the container is held. Returns nanoseconds spent
+	// waiting on the semaphores, or -1 if the container is concurrent and
+	// they were bypassed.
+	const int64_t takeTargets(const ProbeRecord& probe, const Probe::Message& request,
+							  const Uint max, Probe::Message& response);
+
+	// Appends a record about probe to the journal, if there is one, at the
+	// current TFC time.
+	void journal(const Uint type, const ProbeRecord& probe, 
+				 const Probe::Message* msg = nullptr);
+
+	// Journals probe's request, if not null, then each of the count
+	// collided asteroids hitting the fleet.
+	void journalAsteroids(const ProbeRecord& probe, const Probe::Message* request,
+						  const Asteroid* collided, const Uint count);
+
+	// A probe served by runs of a task on m_executor.
+	struct ProbeTask;
+
+	// Queues a run of task unless one is already queued or running.
+	void wakeTask(const std::shared_ptr<ProbeTask>& task);
+
+	// Handles up to TaskBudget messages waiting for task's probe, the same
+	// way updateProbe() does, then returns. Requeues itself if more are
+	// waiting.
+	void runTask(std::shared_ptr<ProbeTask> task);
+
+	// Messages handled per run of a task before others get a turn.
+	static const Uint TaskBudget = 16;
+
+	// Starts f on a thread joined by the destructor. Returns false, without
+	// starting it, once the TFC is being destroyed.
+	bool startThread(const std::function<void(void)>& f);
+
+	// Lists a channel a handler may block on, for the destructor to
+	// interrupt. Returns false once the TFC is being destroyed, when the
+	// handler should give up instead.
+	bool track(const std::shared_ptr<Channel>& channel);
+
+	// Removes one listing of channel made by track().
+	void untrack(const std::shared_ptr<Channel>& channel);
+
+	// Lets ready callbacks, which may run after the TFC is gone, into it.
+	struct CallbackGate;
+
+	Config m_config;
 	AsteroidContainer m_asteroids;
 	// Semaphores for synchronized access to AsteroidContainer.
 	Semaphore m_mutex, m_empty, m_full;
 	// List of all probes that have been launched.
 	std::vector<ProbeRecord> m_probes;
+	mutable std::mutex m_probesMutex;
+	// Next probe ID. Each TFC numbers its own probes from zero, so runs
+	// sharing a process (see BatchRunner) don't skew each other's IDs.
+	std::atomic<Uint> m_probeIDCtr;
 	SOCKET m_socket;
-	bool m_fleetAlive, m_inAsteroidField;
-	int m_shields;
-	Uint m_asteroidsDestroyed;
+	// Extra SO_REUSEPORT listeners, one per reactor after the first.
+	std::vector<SOCKET> m_shardSockets;
+	// Event loops serving probes in ServerMode::REACTOR.
+	std::vector<std::shared_ptr<Reactor>> m_reactors;
 	std::shared_ptr<Timer> m_pClock;
-	std::queue<GUIEvent> m_guiEvents;
-	bool m_scoutActive;
-	Uint m_numPhaserProbesLaunched;
+	// Pushed from every probe handler, consumed by the GUI thread.
+	MPSCQueue<GUIEvent> m_guiEvents;
+
+	// State shared by every probe handler. Flags polled in loops are kept
+	// on separate cache lines; counters are sharded per thread.
+	struct Stats{
+		std::atomic<bool> fleetAlive;
+		char pad0[CACHE_LINE_SIZE];
+		std::atomic<bool> inAsteroidField;
+		char pad1[CACHE_LINE_SIZE];
+		std::atomic<bool> scoutActive;
+		ShardedCounter shieldHits;
+		ShardedCounter asteroidsDestroyed;
+		ShardedCounter phaserProbesLaunched;
+	} m_stats;
+	int m_initError;
+	// Set once the destructor has begun; handlers stop and no more start.
+	std::atomic<bool> m_stopping;
+	// Threads started by startThread(), and those which have returned, to
+	// be joined as the next starts.
+	std::unordered_map<std::thread::id, std::thread> m_threads;
+	std::vector<std::thread::id> m_finished;
+	// Channels handlers may be blocked on (see track()).
+	std::vector<std::shared_ptr<Channel>> m_channels;
+	std::mutex m_threadsMutex;
+	// Closed by the destructor, after which ready callbacks do nothing.
+	std::shared_ptr<CallbackGate> m_gate;
+	// Probes served as tasks, and the work-stealing pool running them. Last,
+	// so queued runs finish before the rest of the TFC is destroyed.
+	// The pool is only started once a probe becomes a task.
+	std::vector<std::shared_ptr<ProbeTask>> m_tasks;
+	std::once_flag m_executorOnce;
+	std::unique_ptr<ThreadPool> m_executor;
 };
 
 // ================================================ //
 
-inline void TFC::enterAsteroidField(void){
-	m_inAsteroidField = true;
-	m_pClock->restart();
+inline TFC::Config::Config(void) :
+containerType(AsteroidContainer::Type::PRIORITY),
+capacity(AsteroidContainer::MAX),
+serverMode(TFC::ServerMode::THREADED),
+numReactors(1),
+clock(nullptr),
+journal(nullptr)
+{
+
 }
 
+// ================================================ //
+
 // Getters
 
+inline const int TFC::getInitError(void) const{
+	return m_initError;
+}
+
 inline const int TFC::getNumProbes(void) const{
+	std::lock_guard<std::mutex> lock(m_probesMutex);
 	return m_probes.size();
 }
 
@@ -140,40 +353,50 @@ inline const Uint TFC::getCurrentTime(void) const{
 inline const GUIEvent TFC::getNextGUIEvent(void){
 	GUIEvent next;
 	ZeroMemory(&next, sizeof(next));
-	if (m_guiEvents.empty()){
+	if (m_guiEvents.tryPop(next) == false){
 		next.type = GUIEventType::NONE;
 	}
-	else{
-		next = m_guiEvents.front();
-		m_guiEvents.pop();
-	}
 
 	return next;
 }
 
+inline bool TFC::waitGUIEvent(GUIEvent& e, const Uint ms){
+	return m_guiEvents.pop(e, ms);
+}
+
+inline const Uint TFC::drainGUIEvents(std::vector<GUIEvent>& events){
+	return m_guiEvents.drain(events);
+}
+
 inline const bool TFC::hasGUIEvent(void) const{
-	return (m_guiEvents.size() > 0);
+	return (m_guiEvents.empty() == false);
 }
 
 inline const Uint TFC::getShields(void) const{
-	return m_shields;
+	int hits = m_stats.shieldHits.get();
+	return (hits < TFC::Shields) ? TFC::Shields - hits : 0;
 }
 
 inline const Uint TFC::getNumAsteroidsDestroyed(void) const{
-	return m_asteroidsDestroyed;
+	return m_stats.asteroidsDestroyed.get();
 }
 
 inline const Uint TFC::getNumAsteroidsAwaitingDestruction(void) const{
-	return (m_asteroidsDestroyed <= 55) ? 55 - m_asteroidsDestroyed :
+	Uint destroyed = this->getNumAsteroidsDestroyed();
+	return (destroyed <= 55) ? 55 - destroyed :
 		0;
 }
 
 inline const bool TFC::isInAsteroidField(void) const{
-	return m_inAsteroidField;
+	return m_stats.inAsteroidField;
+}
+
+inline const bool TFC::isFleetAlive(void) const{
+	return m_stats.fleetAlive;
 }
 
 inline const Uint TFC::getNumPhaserProbesLaunched(void) const{
-	return m_numPhaserProbesLaunched;
+	return m_stats.phaserProbesLaunched.get();
 }
 
 // ================================================ //
@@ -0,0 +1,157 @@
+// ================================================ //
+// File: ThreadPool.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements ThreadPool class.
+// ================================================ //
+
+#include "ThreadPool.hpp"
+
+// ================================================ //
+
+// Pool and index of the worker running on this thread, if any.
+static thread_local const ThreadPool* CurrentPool = nullptr;
+static thread_local Uint CurrentWorker = 0;
+
+// ================================================ //
+
+ThreadPool::ThreadPool(const Uint threads) :
+m_workers(),
+m_threads(),
+m_next(0),
+m_queued(0),
+m_pending(0),
+m_mutex(),
+m_wake(),
+m_idle(),
+m_stop(false)
+{
+	Uint count = threads;
+	if (count == 0){
+		count = std::max<Uint>(1, std::thread::hardware_concurrency());
+	}
+
+	for (Uint i = 0; i < count; ++i){
+		m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+	}
+	for (Uint i = 0; i < count; ++i){
+		m_threads.push_back(std::thread(&ThreadPool::run, this, i));
+	}
+}
+
+// ================================================ //
+
+ThreadPool::~ThreadPool(void)
+{
+	this->wait();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+
+	for (std::vector<std::thread>::iterator itr = m_threads.begin();
+		 itr != m_threads.end(); ++itr){
+		itr->join();
+	}
+}
+
+// ================================================ //
+
+void ThreadPool::submit(const Task& task)
+{
+	Uint index = (CurrentPool == this) ? CurrentWorker :
+		m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+	m_pending.fetch_add(1);
+	{
+		Worker& worker = *m_workers[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(task);
+	}
+	m_queued.fetch_add(1);
+
+	// Lock so a worker between its check and its sleep can't miss this.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+	}
+	m_wake.notify_one();
+}
+
+// ================================================ //
+
+void ThreadPool::wait(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this](){
+		return (m_pending.load() == 0);
+	});
+}
+
+// ================================================ //
+
+void ThreadPool::run(const Uint index)
+{
+	CurrentPool = this;
+	CurrentWorker = index;
+
+	for (;;){
+		Task task;
+		if (this->popLocal(index, task) || this->steal(index, task)){
+			m_queued.fetch_sub(1);
+			task();
+
+			if (m_pending.fetch_sub(1) == 1){
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_idle.notify_all();
+			}
+			continue;
+		}
+
+		// Nothing anywhere, sleep until a task is submitted.
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this](){
+			return (m_stop || m_queued.load() > 0);
+		});
+		if (m_stop && m_queued.load() == 0){
+			return;
+		}
+	}
+}
+
+// ================================================ //
+
+bool ThreadPool::popLocal(const Uint index, Task& task)
+{
+	Worker& worker = *m_workers[index];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty()){
+		return false;
+	}
+
+	task = worker.tasks.back();
+	worker.tasks.pop_back();
+	return true;
+}
+
+// ================================================ //
+
+bool ThreadPool::steal(const Uint index, Task& task)
+{
+	for (Uint i = 1; i < m_workers.size(); ++i){
+		Worker& victim = *m_workers[(index + i) % m_workers.size()];
+		// Don't queue behind a busy victim, move on to the next one.
+		std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+		if (lock.owns_lock() && victim.tasks.empty() == false){
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ================================================ //
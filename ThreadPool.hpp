@@ -0,0 +1,90 @@
+// ================================================ //
+// File: ThreadPool.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines ThreadPool class.
+// ================================================ //
+
+#ifndef __THREADPOOL_HPP__
+#define __THREADPOOL_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+#include <functional>
+
+// ================================================ //
+// A fixed set of worker threads with work stealing. Each worker has its own
+// task deque; it takes work from the back of its own and, when that runs
+// dry, steals from the front of another's. Tasks submitted by a worker stay
+// on that worker's deque, others are dealt out round-robin.
+class ThreadPool
+{
+public:
+	typedef std::function<void(void)> Task;
+
+	// Starts the workers. A thread count of zero uses one per core.
+	explicit ThreadPool(const Uint threads = 0);
+
+	// Finishes every queued task, then stops the workers.
+	~ThreadPool(void);
+
+	// Queues a task to run on some worker.
+	void submit(const Task& task);
+
+	// Blocks until every task submitted so far has finished.
+	void wait(void);
+
+	// Getters
+
+	// Returns number of worker threads.
+	const Uint size(void) const;
+
+private:
+	// Not copyable.
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	struct Worker{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		char pad[CACHE_LINE_SIZE];
+	};
+
+	// Worker thread loop.
+	void run(const Uint index);
+
+	// Takes the newest task from worker index's own deque.
+	bool popLocal(const Uint index, Task& task);
+
+	// Takes the oldest task from any other worker's deque.
+	bool steal(const Uint index, Task& task);
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<std::thread> m_threads;
+	// Next worker to receive a task submitted from outside the pool.
+	std::atomic<Uint> m_next;
+	// Tasks sitting in deques.
+	std::atomic<Uint> m_queued;
+	// Tasks submitted but not finished.
+	std::atomic<Uint> m_pending;
+	// Guards sleeping and waking.
+	std::mutex m_mutex;
+	std::condition_variable m_wake, m_idle;
+	bool m_stop;
+};
+
+// ================================================ //
+
+// Getters
+
+inline const Uint ThreadPool::size(void) const{
+	return static_cast<Uint>(m_threads.size());
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
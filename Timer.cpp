@@ -10,11 +10,12 @@
 
 // ================================================ //
 
-Uint Timer::Multiplier = 1;
+double Timer::Multiplier = 1.0;
 
 // ================================================ //
 
-Timer::Timer(const bool start) :
+Timer::Timer(const bool start, VirtualClock* clock) :
+m_clock(clock),
 m_startTicks(0),
 m_pausedTicks(0),
 m_paused(false),
@@ -39,8 +40,8 @@ const Uint Timer::restart(void)
 	m_started = true;
 	m_paused = false;
 
-	m_startTicks = GetTickCount() * Timer::Multiplier;
-	return m_startTicks;
+	m_startTicks = this->now();
+	return static_cast<Uint>(m_startTicks / 1000000);
 }
 
 // ================================================ //
@@ -58,7 +59,7 @@ void Timer::pause(void)
 	if (m_started == true && m_paused == false){
 		m_paused = true;
 
-		m_pausedTicks = GetTickCount() * Timer::Multiplier - m_startTicks;
+		m_pausedTicks = this->scale(this->now() - m_startTicks);
 	}
 }
 
@@ -69,7 +70,10 @@ void Timer::unpause(void)
 	if (m_paused == true){
 		m_paused = false;
 
-		m_startTicks = GetTickCount() * Timer::Multiplier - m_pausedTicks;
+		// Backdate the start so the paused time carries on from where it was.
+		double ns = (m_clock != nullptr) ? static_cast<double>(m_pausedTicks) :
+			m_pausedTicks / Timer::Multiplier;
+		m_startTicks = this->now() - static_cast<int64_t>(ns);
 
 		m_pausedTicks = 0;
 	}
@@ -78,10 +82,17 @@ void Timer::unpause(void)
 // ================================================ //
 
 const Uint Timer::getTicks(void)
+{
+	return static_cast<Uint>(this->getNanoseconds() / 1000000);
+}
+
+// ================================================ //
+
+const uint64_t Timer::getNanoseconds(void)
 {
 	if (m_started == true){
-		return (m_paused == true) ? m_pausedTicks :
-			static_cast<Uint>(GetTickCount() * Timer::Multiplier - m_startTicks);
+		return static_cast<uint64_t>((m_paused == true) ? m_pausedTicks :
+			this->scale(this->now() - m_startTicks));
 	}
 
 	return 0;
@@ -89,9 +100,34 @@ const Uint Timer::getTicks(void)
 
 // ================================================ //
 
+const int64_t Timer::now(void) const
+{
+	if (m_clock != nullptr){
+		return static_cast<int64_t>(m_clock->now()) * 1000000;
+	}
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ================================================ //
+
+const int64_t Timer::scale(const int64_t ns) const
+{
+	// Virtual time already runs at simulation speed.
+	if (m_clock != nullptr){
+		return ns;
+	}
+
+	return static_cast<int64_t>(ns * Timer::Multiplier);
+}
+
+// ================================================ //
+
 void Timer::Delay(const Uint ms)
 {
-	Sleep(ms / Timer::Multiplier);
+	double ns = ms * 1000000.0 / Timer::Multiplier;
+	std::this_thread::sleep_for(std::chrono::nanoseconds(static_cast<int64_t>(ns)));
 }
 
-// ================================================ //
\ No newline at end of file
+// ================================================ //
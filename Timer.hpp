@@ -7,6 +7,7 @@
 // ================================================ //
 
 #include "stdafx.hpp"
+#include "VirtualClock.hpp"
 
 // ================================================ //
 
@@ -15,12 +16,14 @@
 
 // ================================================ //
 
-// A timer that starts from zero. Uses milliseconds.
+// A timer that starts from zero. Uses milliseconds, kept internally as 64-bit
+// nanoseconds. Reads the monotonic high-resolution clock scaled by
+// Multiplier, or a VirtualClock if bound to one.
 class Timer
 {
 public:
-	// Empty constructor.
-	explicit Timer(const bool start = false);
+	// Empty constructor. If clock is not null, ticks are read from it.
+	explicit Timer(const bool start = false, VirtualClock* clock = nullptr);
 
 	// Empty destructor.
 	~Timer(void);
@@ -40,6 +43,9 @@ public:
 	// Get the time in milliseconds since the timer was started.
 	const Uint getTicks(void);
 
+	// Get the time in nanoseconds since the timer was started.
+	const uint64_t getNanoseconds(void);
+
 	// Getters
 
 	// Returns true if the timer is active.
@@ -50,16 +56,26 @@ public:
 
 	// --- //
 
-	// Delays the calling thread in ms.
+	// Delays the calling thread in ms of wall-clock time. Virtual time is
+	// advanced by its driver instead.
 	static void Delay(const Uint ms);
 
 	// A multiplier applied to speed up the simulation.
-	// e.g., set to 10 to run the simulation at 10x speed.
-	static Uint Multiplier;
+	// e.g., set to 10 to run the simulation at 10x speed, or 0.5 for half.
+	static double Multiplier;
 
 private:
-	Uint m_startTicks;
-	Uint m_pausedTicks;
+	// Returns the current absolute time in ns from the bound clock.
+	const int64_t now(void) const;
+
+	// Converts elapsed clock time to simulated time (ns).
+	const int64_t scale(const int64_t ns) const;
+
+	VirtualClock* m_clock;
+	// Clock reading at start (ns).
+	int64_t m_startTicks;
+	// Simulated time elapsed when paused (ns).
+	int64_t m_pausedTicks;
 	bool m_paused;
 	bool m_started;
 };
@@ -0,0 +1,179 @@
+// ================================================ //
+// File: TimerWheel.cpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Implements TimerWheel class.
+// ================================================ //
+
+#include "TimerWheel.hpp"
+
+// ================================================ //
+
+TimerWheel::TimerWheel(const Uint workers) :
+m_current(0),
+m_numPending(0),
+m_clock(true),
+m_mutex(),
+m_wake(),
+m_stop(false),
+m_pool(workers),
+m_thread()
+{
+	m_thread = std::thread(&TimerWheel::run, this);
+}
+
+// ================================================ //
+
+TimerWheel::~TimerWheel(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	m_thread.join();
+}
+
+// ================================================ //
+
+void TimerWheel::schedule(const Uint delay, const Task& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// Catch up first so the delay counts from now, even if the wheel
+		// has been idle.
+		uint64_t now = m_clock.getTicks();
+		std::vector<Entry> ready;
+		while (m_current < now){
+			this->tick(ready);
+		}
+		for (std::vector<Entry>::iterator itr = ready.begin(); itr != ready.end(); ++itr){
+			m_pool.submit(itr->task);
+		}
+
+		Entry entry;
+		// A zero delay fires on the next tick.
+		entry.due = m_current + std::max<Uint>(delay, 1);
+		entry.task = task;
+		this->insert(entry);
+		++m_numPending;
+	}
+	m_wake.notify_one();
+}
+
+// ================================================ //
+
+void TimerWheel::run(void)
+{
+	std::vector<Entry> ready;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_stop == false){
+		if (m_numPending == 0){
+			// Nothing to fire, sleep until something is scheduled.
+			m_wake.wait(lock);
+			continue;
+		}
+
+		uint64_t now = m_clock.getTicks();
+		while (m_current < now && m_numPending > 0){
+			this->tick(ready);
+		}
+		if (m_numPending == 0){
+			// Idle wheels don't keep ticking; jump to now.
+			m_current = std::max(m_current, now);
+		}
+
+		if (ready.empty() == false){
+			lock.unlock();
+			for (std::vector<Entry>::iterator itr = ready.begin(); itr != ready.end(); ++itr){
+				m_pool.submit(itr->task);
+			}
+			ready.clear();
+			lock.lock();
+			continue;
+		}
+
+		// Sleep until the next slot with work comes around, in real time.
+		// Anything scheduled sooner wakes the wheel early.
+		uint64_t wait = this->nextEvent() - m_current;
+		m_wake.wait_for(lock, std::chrono::nanoseconds(
+			static_cast<int64_t>(wait * 1000000.0 / Timer::Multiplier)));
+	}
+}
+
+// ================================================ //
+
+void TimerWheel::insert(const Entry& entry)
+{
+	uint64_t delta = (entry.due > m_current) ? entry.due - m_current : 0;
+
+	// Find the lowest level whose span covers the delay.
+	Uint level = 0;
+	while (level + 1 < TimerWheel::Levels &&
+		   delta >= (static_cast<uint64_t>(1) << (TimerWheel::SlotBits * (level + 1)))){
+		++level;
+	}
+
+	Uint slot = static_cast<Uint>(
+		(entry.due >> (TimerWheel::SlotBits * level)) & (TimerWheel::Slots - 1));
+	m_slots[level][slot].push_back(entry);
+}
+
+// ================================================ //
+
+void TimerWheel::tick(std::vector<Entry>& ready)
+{
+	++m_current;
+
+	// When a level wraps, pull the next slot of the level above down.
+	for (Uint level = 1; level < TimerWheel::Levels; ++level){
+		uint64_t below = m_current >> (TimerWheel::SlotBits * (level - 1));
+		if ((below & (TimerWheel::Slots - 1)) != 0){
+			break;
+		}
+
+		Uint slot = static_cast<Uint>(
+			(m_current >> (TimerWheel::SlotBits * level)) & (TimerWheel::Slots - 1));
+		std::vector<Entry> cascade;
+		cascade.swap(m_slots[level][slot]);
+		for (std::vector<Entry>::iterator itr = cascade.begin(); itr != cascade.end(); ++itr){
+			this->insert(*itr);
+		}
+	}
+
+	std::vector<Entry>& due = m_slots[0][m_current & (TimerWheel::Slots - 1)];
+	for (std::vector<Entry>::iterator itr = due.begin(); itr != due.end(); ++itr){
+		ready.push_back(*itr);
+	}
+	m_numPending -= static_cast<Uint>(due.size());
+	due.clear();
+}
+
+// ================================================ //
+
+const uint64_t TimerWheel::nextEvent(void) const
+{
+	// Level 0 holds every entry due within the next Slots ms, one due time
+	// per slot; the rest wait above until a cascade brings them down.
+	uint64_t next = 0;
+	Uint near = 0;
+	for (uint64_t t = m_current + 1; t <= m_current + TimerWheel::Slots; ++t){
+		const std::vector<Entry>& slot = m_slots[0][t & (TimerWheel::Slots - 1)];
+		if (slot.empty() == false){
+			if (next == 0){
+				next = t;
+			}
+			near += static_cast<Uint>(slot.size());
+		}
+	}
+
+	uint64_t cascade = (m_current | (TimerWheel::Slots - 1)) + 1;
+	if (near < m_numPending && (next == 0 || cascade < next)){
+		next = cascade;
+	}
+
+	return next;
+}
+
+// ================================================ //
@@ -0,0 +1,106 @@
+// ================================================ //
+// File: TimerWheel.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines TimerWheel class.
+// ================================================ //
+
+#ifndef __TIMERWHEEL_HPP__
+#define __TIMERWHEEL_HPP__
+
+// ================================================ //
+
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+
+// ================================================ //
+// Hierarchical timing wheel with 1 ms resolution in simulation time (see
+// Timer::Multiplier). Level 0 has one slot per ms; each higher level covers
+// Slots times the span of the one below, and its entries cascade down as
+// their slot comes around, so scheduling and firing are O(1) however many
+// timers are pending. A single thread advances the wheel and hands due tasks
+// to a small pool of workers, so thousands of "wait N ms then act" timers
+// need no sleeping thread each.
+class TimerWheel
+{
+public:
+	typedef std::function<void(void)> Task;
+
+	// Starts the wheel's thread and workers. A worker count of zero uses
+	// one per core.
+	explicit TimerWheel(const Uint workers = 0);
+
+	// Stops the wheel. Tasks not yet due are dropped; tasks already handed
+	// to workers finish first.
+	~TimerWheel(void);
+
+	// Runs task on a worker once delay ms have passed.
+	void schedule(const Uint delay, const Task& task);
+
+	// Getters
+
+	// Returns number of tasks waiting to become due.
+	const Uint getNumPending(void) const;
+
+	// --- //
+
+	// Slots per level, as a power of two.
+	static const Uint SlotBits = 8;
+	static const Uint Slots = 1 << SlotBits;
+	// Four levels of 256 slots span 2^32 ms.
+	static const Uint Levels = 4;
+
+private:
+	// Not copyable.
+	TimerWheel(const TimerWheel&);
+	TimerWheel& operator=(const TimerWheel&);
+
+	struct Entry{
+		// Wheel time at which the task is due (ms).
+		uint64_t due;
+		Task task;
+	};
+
+	// Thread advancing the wheel in step with the clock.
+	void run(void);
+
+	// Files an entry in the slot for its due time. Lock must be held.
+	void insert(const Entry& entry);
+
+	// Advances the wheel by one ms, cascading higher levels and moving due
+	// entries to ready. Lock must be held.
+	void tick(std::vector<Entry>& ready);
+
+	// Returns the wheel time of the next tick with work to do: the soonest
+	// non-empty level 0 slot, or the next cascade if that comes first and
+	// anything waits above level 0. Lock must be held, with something
+	// pending.
+	const uint64_t nextEvent(void) const;
+
+	std::vector<Entry> m_slots[Levels][Slots];
+	// Current wheel time (ms).
+	uint64_t m_current;
+	Uint m_numPending;
+	Timer m_clock;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_stop;
+	ThreadPool m_pool;
+	std::thread m_thread;
+};
+
+// ================================================ //
+
+// Getters
+
+inline const Uint TimerWheel::getNumPending(void) const{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_numPending;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
@@ -0,0 +1,69 @@
+// ================================================ //
+// File: VirtualClock.hpp
+// Author: Jordan Sparks
+// COSC 4327 Operating Systems Lab 2, Dr. Burris
+// ================================================ //
+// Defines VirtualClock class.
+// ================================================ //
+
+#ifndef __VIRTUALCLOCK_HPP__
+#define __VIRTUALCLOCK_HPP__
+
+// ================================================ //
+
+#include "stdafx.hpp"
+
+// ================================================ //
+// Simulated time in milliseconds, advanced explicitly by a discrete-event
+// driver instead of by the wall clock. A Timer bound to one reads it in
+// place of GetTickCount(). Not thread-safe; owned by a single simulation.
+class VirtualClock
+{
+public:
+	// Starts at time.
+	explicit VirtualClock(const Uint time = 0);
+
+	// Moves the clock forward by ms.
+	void advance(const Uint ms);
+
+	// Moves the clock to time. Time never runs backwards.
+	void set(const Uint time);
+
+	// Getters
+
+	// Returns current simulated time in ms.
+	const Uint now(void) const;
+
+private:
+	Uint m_time;
+};
+
+// ================================================ //
+
+inline VirtualClock::VirtualClock(const Uint time) :
+m_time(time)
+{
+
+}
+
+inline void VirtualClock::advance(const Uint ms){
+	m_time += ms;
+}
+
+inline void VirtualClock::set(const Uint time){
+	if (time > m_time){
+		m_time = time;
+	}
+}
+
+// Getters
+
+inline const Uint VirtualClock::now(void) const{
+	return m_time;
+}
+
+// ================================================ //
+
+#endif
+
+// ================================================ //
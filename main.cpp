@@ -10,6 +10,10 @@
 #include "Probe.hpp"
 #include "Timer.hpp"
 #include "GUI.hpp"
+#include "Console.hpp"
+#include "TimerWheel.hpp"
+#include "GUIRenderer.hpp"
+#include "LatencyHistogram.hpp"
 #include "resource.h"
 
 // ================================================ //
@@ -28,19 +32,6 @@ static void UpdateLog(HWND hwnd, const std::string& str)
 
 // ================================================ //
 
-static void UpdateShields(HWND hwnd, const Uint shields)
-{
-	// Link progress bar to shield power.
-	SendDlgItemMessage(hwnd, IDC_PROGRESS_SHIELDS, PBM_SETPOS,
-					   static_cast<WPARAM>(shields), 0);
-
-	// Update number of hits on shields.
-	std::string buffer = "Shields (Hits: " + toString(5 - shields) + ")";
-	SetDlgItemText(hwnd, IDC_STATIC_SHIELDS, buffer.c_str());
-}
-
-// ================================================ //
-
 static void AddProbeToList(HWND hList, const Uint id, 
 						   const Uint type, const unsigned state)
 {	
@@ -74,168 +65,24 @@ static void AddProbeToList(HWND hList, const Uint id,
 // A thread to process GUI updates.
 static void UpdateGUI(HWND hwnd, TFC* tfc)
 {
-	// Used to update elapsed time every second.
-	Timer update(true);
-	// Index counter for asteroid listview.
-	Uint asteroidIndex = 0;
-
-	while (hwnd != nullptr){		
-		UpdateWindow(hwnd);						
-
-		// Check for GUI events from TFC.
-		if (tfc->hasGUIEvent()){
-			GUIEvent e = tfc->getNextGUIEvent();
-			switch (e.type){
-			default:
-			case GUIEventType::NONE:
-				break;
-
-			case GUIEventType::ASTEROID_FOUND:
-				{
-					// Insert asteroid data into listview.
-					HWND hList = GetDlgItem(hwnd, IDC_LIST_ASTEROIDS);
-					InsertListviewItem(hList, asteroidIndex, toString(e.asteroid.id));
-					SetListviewItem(hList, asteroidIndex, 1, toString(e.asteroid.mass));
-					++asteroidIndex;
-
-					// Update the TFC log.
-					std::string buffer = "Asteroid " + toString(e.asteroid.id) + " discovered.";
-					UpdateLog(hwnd, buffer);
-
-					// Update number of asteroids in stack.
-					buffer = "Asteroids (Count: " + toString(asteroidIndex) + ")";
-					SetDlgItemText(hwnd, IDC_STATIC_LIST_ASTEROIDS_TITLE, buffer.c_str());
-
-					printf("***Asteroid %d added to list\n\n", e.asteroid.id);
-				}
-				break;
-
-			case GUIEventType::ASTEROID_REMOVED:				
-				{
-					// Find listview item for removed asteroid and delete it.
-					HWND hList = GetDlgItem(hwnd, IDC_LIST_ASTEROIDS);
-					// Find index of listview item with asteroid (e.x holds ID).
-					int index = GetListviewItemIndex(hList, 0, toString(e.x));
-					if (index != -1){
-						SendMessage(hList, LVM_DELETEITEM, static_cast<WPARAM>(index), 0);
-					}
-					--asteroidIndex;
-
-					// Update asteroids awaiting destruction.
-					std::string buffer = "Asteroids Awaiting Destruction: " + 
-						toString(tfc->getNumAsteroidsAwaitingDestruction());
-					SetDlgItemText(hwnd, IDC_STATIC_NUMASTEROIDS, buffer.c_str());
-
-					// Update asteroids destroyed.
-					buffer = "Asteroids Successfully Destroyed: " +
-						toString(tfc->getNumAsteroidsDestroyed());
-					SetDlgItemText(hwnd, IDC_STATIC_ASTEROIDS_DESTROYED, buffer.c_str());
-
-					// Update TFC log.
-					buffer = "Asteroid " + toString(e.x) + " removed from queue.";
-					UpdateLog(hwnd, buffer);
-
-					// Update number of asteroids in stack.
-					buffer = "Asteroids (Count: " + toString(asteroidIndex) + ")";
-					SetDlgItemText(hwnd, IDC_STATIC_LIST_ASTEROIDS_TITLE, buffer.c_str());
-				}
-				break;
-
-			case GUIEventType::ASTEROID_DESTROYED:
-				{
-					// Update asteroids awaiting destruction.
-					std::string buffer = "Asteroids Awaiting Destruction: " + 
-						toString(tfc->getNumAsteroidsAwaitingDestruction());
-					SetDlgItemText(hwnd, IDC_STATIC_NUMASTEROIDS, buffer.c_str());
-
-					// Update asteroids destroyed.
-					buffer = "Asteroids Successfully Destroyed: " +
-						toString(tfc->getNumAsteroidsDestroyed());
-					SetDlgItemText(hwnd, IDC_STATIC_ASTEROIDS_DESTROYED, buffer.c_str());
-
-					buffer = "Asteroid " + toString(e.x) + " destroyed by probe " + 
-						toString(e.id);
-					UpdateLog(hwnd, buffer);
-				}
-				break;
-
-			case GUIEventType::ASTEROID_COLLISION:
-				UpdateShields(hwnd, tfc->getShields());
-				{
-					std::string buffer = "Asteroid " + toString(e.id) +
-						" collided with TFC!";
-					UpdateLog(hwnd, buffer);
-				}
-				break;
-
-			case GUIEventType::PROBE_TERMINATED:			
-				{
-					// Remove probe from listview.
-					HWND hList = GetDlgItem(hwnd, IDC_LIST_PROBES);
-					int index = GetListviewItemIndex(hList, 0, toString(e.id));
-					if (index != -1){
-						SendMessage(hList, LVM_DELETEITEM, static_cast<WPARAM>(index), 0);
-					}
-
-					// Update number of probes.
-					std::string buffer = "Launched Probes (Count: " +
-						toString(tfc->getNumProbes()) + ")";
-					SetDlgItemText(hwnd, IDC_STATIC_LIST_PROBES_TITLE, buffer.c_str());
-
-					buffer = "Probe " + toString(e.id) + " lost to asteroid " +
-						toString(e.x) + "!";
-					UpdateLog(hwnd, buffer);
-				}
-				break;
-
-			case GUIEventType::FLEET_DESTROYED:						
-				SetDlgItemText(hwnd, IDC_STATIC_STATUS, "Fleet Status: Destroyed");	
-				{
-					std::string msg = "The fleet has been destroyed.\r\n\r\n" +
-						toString(tfc->getNumPhaserProbesLaunched()) + " phaser probes used.";
-
-					UpdateLog(hwnd, "Fleet destroyed!");
-
-					MessageBox(hwnd, msg.c_str(), "Failure",
-							   MB_OK | MB_ICONWARNING | MB_SETFOREGROUND);
-				}											
-				break;
-
-			case GUIEventType::FLEET_SURVIVED:
-				SetDlgItemText(hwnd, IDC_STATIC_STATUS, "Fleet Status: Arrived");
-				{
-					std::string msg = "The fleet successfully nagivated the asteroid field"
-						" and has arrived at Talos IV!\r\n\r\n" + 
-						toString(tfc->getNumPhaserProbesLaunched()) +
-						" phaser probes used.";
-					// Update asteroids awaiting destruction.
-					std::string buffer = "Asteroids Awaiting Destruction: " +
-						toString(tfc->getNumAsteroidsAwaitingDestruction());
-					SetDlgItemText(hwnd, IDC_STATIC_NUMASTEROIDS, buffer.c_str());
-
-					// Update asteroids destroyed.
-					buffer = "Asteroids Successfully Destroyed: " +
-						toString(tfc->getNumAsteroidsDestroyed());
-					SetDlgItemText(hwnd, IDC_STATIC_ASTEROIDS_DESTROYED, buffer.c_str());
-
-					UpdateLog(hwnd, "Fleet arrived!");
-
-					MessageBox(hwnd, msg.c_str(), "Success",
-							   MB_OK | MB_ICONINFORMATION | MB_SETFOREGROUND);
-				}								
-				break;
+	GUIRenderer renderer(hwnd, tfc);
+	std::vector<GUIEvent> events;
+
+	while (hwnd != nullptr){
+		// Sleep until an event arrives or the next frame is due, then fold
+		// in everything pending and draw at most one frame.
+		GUIEvent e;
+		if (tfc->waitGUIEvent(e, renderer.getTimeToNextFrame())){
+			renderer.apply(e);
+			tfc->drainGUIEvents(events);
+			for (std::vector<GUIEvent>::iterator itr = events.begin();
+				 itr != events.end(); ++itr){
+				renderer.apply(*itr);
 			}
+			events.clear();
 		}
 
-		// Update elapsed time every one second.
-		if (tfc->isInAsteroidField()){
-			if (update.getTicks() > 1000){
-				Uint time = tfc->getCurrentTime() / 1000;
-				std::string buf("Elapsed Time: " + toString(time));
-				SetDlgItemText(hwnd, IDC_STATIC_TIME, buf.c_str());
-				update.restart();
-			}
-		}
+		renderer.render();
 	}
 }
 
@@ -245,6 +92,8 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
 	// Initialize the TFC here.
 	static TFC tfc;
+	// Probes run as timers on this wheel instead of a thread each.
+	static TimerWheel wheel;
 	// Array of smart pointers storing allocate Probe objects. They are 
 	// automatically freed when execution leaves this scope.
 	static std::vector<std::shared_ptr<Probe>> probes;
@@ -263,6 +112,13 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
 	case WM_INITDIALOG:	
 		{
+			if (tfc.getInitError() != 0){
+				std::string str = "TFC failed to initialize server (Error: "
+					+ toString(tfc.getInitError()) + ").";
+				MessageBox(hwnd, str.c_str(), "Error!", 
+						   MB_OK | MB_ICONERROR | MB_SETFOREGROUND);
+			}
+
 			// Setup GUI items.
 			// Asteroid listview.						  			
 			HWND hList = GetDlgItem(hwnd, IDC_LIST_ASTEROIDS);
@@ -306,7 +162,7 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			// Create initial probes (one scout and two photon).
 			// Scout probe.
 			std::shared_ptr<Probe> probe(new Probe(Probe::Type::SCOUT));			
-			if (probe->launch() == true){
+			if (probe->launch(&wheel, Probe::Transport::IN_PROCESS) == true){
 				probes.push_back(probe);
 				AddProbeToList(hList, probe->getID(), Probe::Type::SCOUT, probe->getState());
 			}
@@ -315,7 +171,7 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			for (int i = 0; i < 2; ++i){
 				// Re-allocate a probe.
 				probe.reset(new Probe(Probe::Type::PHOTON));				
-				if (probe->launch() == true){
+				if (probe->launch(&wheel, Probe::Transport::IN_PROCESS) == true){
 					probes.push_back(probe);
 					AddProbeToList(hList, probe->getID(), Probe::Type::PHOTON, probe->getState());
 				}
@@ -374,10 +230,10 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			{				
 				// Allocate a new artificial phaser probe and launch it. 
 				// A Probe object is allocated and connects to the TFC server.
-				// If successful, it spawns a thread to run itself and the TFC
-				// also creates a thread to handle the Probe's socket.
+				// If successful, it runs on the timer wheel and the TFC creates
+				// a thread to handle the Probe's channel.
 				std::shared_ptr<Probe> probe(new Probe(Probe::Type::PHASER));
-				if (probe->launch() == true){
+				if (probe->launch(&wheel, Probe::Transport::IN_PROCESS) == true){
 					probes.push_back(probe);
 
 					AddProbeToList(GetDlgItem(hwnd, IDC_LIST_PROBES), probe->getID(),
@@ -410,6 +266,14 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 		return FALSE;
 
 	case WM_CLOSE:		
+		// Keep the run's latency percentiles for later comparison.
+		{
+			FILE* out = fopen("latency.txt", "w");
+			if (out != nullptr){
+				Telemetry::Print(out);
+				fclose(out);
+			}
+		}
 		EndDialog(hwnd, 0);
 		return FALSE;
 	}
@@ -421,6 +285,11 @@ static BOOL CALLBACK MainProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
 int main(int argc, char** argv)
 {
+	// Console modes need no GUI.
+	if (Console::Handles(argc, argv)){
+		return Console::Run(argc, argv);
+	}
+
 	// Initialize Winsock, begin using WS2_32.DLL.
 	WSAData wsaData;
 	if (WSAStartup(0x101, &wsaData) != 0){
@@ -11,44 +11,77 @@
 
 // ================================================ //
 
-// Define Windows version.
-#define STRICT
-#define _WIN32_WINNT 0x0600
-#ifndef WIN32_LEAN_AND_MEAN
-	#define WIN32_LEAN_AND_MEAN
-#endif
-
 // Some common typedefs.
 
 typedef unsigned int Uint;
 
+// Assumed size of a CPU cache line, used to pad shared atomics apart.
+#define CACHE_LINE_SIZE 64
+
 // ================================================ //
 
 // C++ STL
 #include <memory>
 #include <thread>
+#include <chrono>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <string>
 #include <sstream>
 #include <vector>
 #include <list>
 #include <queue>
+#include <deque>
 #include <random>
 #include <cstdio>
+#include <cstdint>
+
+#if defined(_WIN32)
+
+// Define Windows version.
+#define STRICT
+#define _WIN32_WINNT 0x0600
+#ifndef WIN32_LEAN_AND_MEAN
+	#define WIN32_LEAN_AND_MEAN
+#endif
 
 // Windows
 #include <Windows.h>
-#include <CommCtrl.h>
-#include <commdlg.h>
-#include <Shlwapi.h>
-#include <ShlObj.h>
 
 // Network
 #include <WinSock2.h>
 #include <WS2tcpip.h>
 #include <IPHlpApi.h>
 
+#else
+
+// POSIX network
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+// The Winsock names used throughout, mapped onto BSD sockets.
+typedef int SOCKET;
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#define SD_BOTH SHUT_RDWR
+#define WSAGetLastError() (errno)
+#define ZeroMemory(p, size) memset((p), 0, (size))
+
+inline int closesocket(const SOCKET socket){
+	return ::close(socket);
+}
+
+#endif
+
 // ================================================ //
 
 // Converts anything to a std::string.